@@ -31,6 +31,7 @@
 #pragma once
 
 #include "vulkan.h"
+#include <atomic>
 #include <cassert>
 #include <tuple>
 
@@ -47,7 +48,7 @@
 #define LLPC_INTERFACE_MAJOR_VERSION 45
 
 /// LLPC minor interface version.
-#define LLPC_INTERFACE_MINOR_VERSION 4
+#define LLPC_INTERFACE_MINOR_VERSION 9
 
 #ifndef LLPC_CLIENT_INTERFACE_MAJOR_VERSION
 #if VFX_INSIDE_SPVGEN
@@ -71,6 +72,11 @@
 //* %Version History
 //* | %Version | Change Description                                                                                    |
 //* | -------- | ----------------------------------------------------------------------------------------------------- |
+//* |     45.9 | Added IPipelineDumper::FlushPipelineDumps, as pipeline dump files are now written asynchronously      |
+//* |     45.8 | Added workgroupIdSwizzle and workgroupIdSwizzleSize to PipelineShaderOptions                          |
+//* |     45.7 | Added pCancelFlag and timeLimitMs to Graphics/ComputePipelineBuildInfo                                |
+//* |     45.6 | Added PipelineOptions::fastCompile, and tiered pipeline builds to ICompiler                           |
+//* |     45.5 | Added asynchronous pipeline builds to ICompiler, and Result::ErrorCancelled                           |
 //* |     45.4 | Added disableLicmThreshold, unrollHintThreshold, and dontUnrollHintThreshold to PipelineShaderOptions |
 //* |     45.3 | Add pipelinedump function to enable BeginPipelineDump and GetPipelineName                             |                                                               |
 //* |     45.2 | Add GFX IP plus checker to GfxIpVersion                                                               |
@@ -153,6 +159,8 @@ enum class Result : int {
   ErrorInvalidPointer = -(0x00000005),
   /// The operaton encountered an unknown error
   ErrorUnknown = -(0x00000006),
+  /// The operation was cancelled before it completed
+  ErrorCancelled = -(0x00000007),
 };
 
 /// Represents the base data type
@@ -344,6 +352,8 @@ struct PipelineOptions {
   unsigned shadowDescriptorTablePtrHigh;                 ///< Sets high part of VA ptr for shadow descriptor table.
   ExtendedRobustness extendedRobustness;                 ///< ExtendedRobustness is intended to correspond to the
                                                          ///  features of VK_EXT_robustness2.
+  bool fastCompile;                                      ///< If set, the pipeline is compiled for minimum compile
+                                                         ///  time rather than best code.
 };
 
 /// Prototype of allocator for output data buffer, used in shader-specific operations.
@@ -435,6 +445,14 @@ enum class DenormalMode : unsigned {
   Preserve = 0x2,    ///< Denormals preserved
 };
 
+/// Enumerates the orders in which compute workgroup IDs can be remapped over the dispatch grid.
+enum class WorkgroupIdSwizzle : unsigned {
+  None = 0x0,         ///< No remapping; workgroups walk the grid in row-major order
+  Tiled = 0x1,        ///< Row-major order within NxN tiles of workgroups, tiles in row-major order
+  Morton = 0x2,       ///< Z-order (Morton) within NxN tiles of workgroups, tiles in row-major order
+  ColumnStrips = 0x3, ///< Row-major order within N-wide strips of workgroups, walking each strip down the grid
+};
+
 /// If next available quad falls outside tile aligned region of size defined by this enumeration the SC will force end
 /// of vector in the SC to shader wavefront.
 enum class WaveBreakSize : unsigned {
@@ -584,6 +602,14 @@ struct PipelineShaderOptions {
 
   /// Threshold to use for loops with "DontUnroll" hint (0 = use llvm.llop.unroll.disable).
   unsigned dontUnrollHintThreshold;
+
+  /// Order in which to remap gl_WorkGroupID over the dispatch grid in a compute shader, to improve cache locality
+  /// between neighbouring workgroups. Assumes a dispatch with a zero base workgroup.
+  WorkgroupIdSwizzle workgroupIdSwizzle;
+
+  /// Tile or strip width N in workgroups for workgroupIdSwizzle (0 = default of 8). Must be a power of two for
+  /// WorkgroupIdSwizzle::Morton.
+  unsigned workgroupIdSwizzleSize;
 };
 
 /// Represents YCbCr sampler meta data in resource descriptor
@@ -746,6 +772,11 @@ struct GraphicsPipelineBuildInfo {
   NggState nggState;       ///< NGG state used for tuning and debugging
   PipelineOptions options; ///< Per pipeline tuning/debugging options
   bool unlinked;           ///< True to build an "unlinked" half-pipeline ELF
+
+  const std::atomic<bool> *pCancelFlag; ///< If not null, the build is abandoned with Result::ErrorCancelled once
+                                        ///  the client sets the flag (possibly from another thread)
+  unsigned timeLimitMs;                 ///< If non-zero, the build is abandoned with Result::ErrorCancelled once it
+                                        ///  has taken this many milliseconds
 };
 
 /// Represents info to build a compute pipeline.
@@ -764,6 +795,11 @@ struct ComputePipelineBuildInfo {
 #endif
   PipelineOptions options; ///< Per pipeline tuning options
   bool unlinked;           ///< True to build an "unlinked" half-pipeline ELF
+
+  const std::atomic<bool> *pCancelFlag; ///< If not null, the build is abandoned with Result::ErrorCancelled once
+                                        ///  the client sets the flag (possibly from another thread)
+  unsigned timeLimitMs;                 ///< If non-zero, the build is abandoned with Result::ErrorCancelled once it
+                                        ///  has taken this many milliseconds
 };
 
 // =====================================================================================================================
@@ -819,6 +855,12 @@ public:
   /// @param [in]  pStr             Extra string info to dump
   static void VKAPI_CALL DumpPipelineExtraInfo(void *pDumpFile, const char *pStr);
 
+  /// Waits until all pipeline dump files have been written. Dump files are written on a background thread, so a
+  /// client that wants to read them back, or that is about to exit abnormally, should call this first.
+  ///
+  /// @returns : Number of dump files dropped since the last flush because they could not be created or written.
+  static unsigned VKAPI_CALL FlushPipelineDumps();
+
   /// Gets shader module hash code.
   ///
   /// @param [in]  pModuleData   Pointer to the shader module data.
@@ -510,6 +510,7 @@ private:
 
   // Read compute shader input
   llvm::Value *readCsBuiltIn(BuiltInKind builtIn, const llvm::Twine &instName = "");
+  llvm::Value *swizzleWorkgroupId(llvm::Value *workgroupId);
 
   // Read vertex shader input
   llvm::Value *readVsBuiltIn(BuiltInKind builtIn, const llvm::Twine &instName = "");
@@ -842,6 +843,8 @@ private:
   };
 
   unsigned getShaderSubgroupSize();
+  llvm::Value *createClusterStep(llvm::Value *const clusterSize, unsigned minClusterSize, bool exactSize,
+                                 llvm::Value *const result, std::function<llvm::Value *()> createStep);
   llvm::Value *createGroupArithmeticIdentity(GroupArithOp groupArithOp, llvm::Type *const type);
   llvm::Value *createGroupArithmeticOperation(GroupArithOp groupArithOp, llvm::Value *const x, llvm::Value *const y);
   llvm::Value *createInlineAsmSideEffect(llvm::Value *const value);
@@ -31,6 +31,7 @@
 #include "BuilderRecorder.h"
 #include "lgc/LgcContext.h"
 #include "lgc/state/PipelineState.h"
+#include "lgc/state/WaveSizeHeuristic.h"
 #include "lgc/util/Internal.h"
 #include "llvm/Support/Debug.h"
 
@@ -98,11 +99,14 @@ BuilderReplayer::BuilderReplayer(Pipeline *pipeline)
 bool BuilderReplayer::runOnModule(Module &module) {
   LLVM_DEBUG(dbgs() << "Running the pass of replaying LLPC builder calls\n");
 
-  // Set up the pipeline state from the specified linked IR module.
+  // Get the pipeline state. PipelineStateWrapper reads it from IR metadata only if it was not handed the
+  // front-end's PipelineState directly.
   PipelineState *pipelineState = getAnalysis<PipelineStateWrapper>().getPipelineState(&module);
-  pipelineState->readState(&module);
   pipelineState->initializePackInOut();
 
+  // Builder lowering depends on the wave size, so select it for each shader before replaying anything.
+  WaveSizeHeuristic(pipelineState).run(module);
+
   // Create the BuilderImpl to replay into, passing it the PipelineState
   LgcContext *builderContext = pipelineState->getLgcContext();
   m_builder.reset(builderContext->createBuilder(pipelineState, /*useBuilderRecorder=*/false));
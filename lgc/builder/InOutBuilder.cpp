@@ -821,9 +821,15 @@ Value *InOutBuilder::readCsBuiltIn(BuiltInKind builtIn, const Twine &instName) {
     return load;
   }
 
-  case BuiltInWorkgroupId:
+  case BuiltInWorkgroupId: {
     // WorkgroupId is a v3i32 shader input (three SGPRs set up by hardware).
-    return ShaderInputs::getInput(ShaderInput::WorkgroupId, *this);
+    Value *workgroupId = ShaderInputs::getInput(ShaderInput::WorkgroupId, *this);
+    // A compute library cannot read NumWorkgroups the way a compute shader does, so it never swizzles.
+    if (getPipelineState()->getShaderOptions(m_shaderStage).workgroupIdSwizzle != WorkgroupIdSwizzle::None &&
+        !getPipelineState()->isComputeLibrary())
+      workgroupId = swizzleWorkgroupId(workgroupId);
+    return workgroupId;
+  }
 
   case BuiltInLocalInvocationId: {
     // LocalInvocationId is a v3i32 shader input (three VGPRs set up in hardware).
@@ -892,6 +898,82 @@ Value *InOutBuilder::readCsBuiltIn(BuiltInKind builtIn, const Twine &instName) {
   }
 }
 
+// =====================================================================================================================
+// Remap the X and Y of the workgroup ID over the dispatch grid in the order given by the workgroupIdSwizzle shader
+// option, so that workgroups that run at the same time touch neighbouring data. The remapping is a bijection on each
+// XY slice of the grid, including the partial tiles or strips at its right and bottom edges. It assumes the dispatch
+// has a zero base workgroup.
+//
+// @param workgroupId : The workgroup ID as set up by hardware (v3i32)
+// @returns : The remapped workgroup ID
+Value *InOutBuilder::swizzleWorkgroupId(Value *workgroupId) {
+  const auto &shaderOptions = getPipelineState()->getShaderOptions(m_shaderStage);
+  WorkgroupIdSwizzle swizzle = shaderOptions.workgroupIdSwizzle;
+  unsigned size = shaderOptions.workgroupIdSwizzleSize != 0 ? shaderOptions.workgroupIdSwizzleSize : 8;
+  if (swizzle == WorkgroupIdSwizzle::Morton)
+    size = PowerOf2Floor(size);
+  if (size <= 1)
+    return workgroupId;
+
+  Value *const tileSize = getInt32(size);
+  auto createUMin = [this](Value *lhs, Value *rhs) { return CreateSelect(CreateICmpULT(lhs, rhs), lhs, rhs); };
+
+  Value *const numWorkgroups = readCsBuiltIn(BuiltInNumWorkgroups);
+  Value *const numX = CreateExtractElement(numWorkgroups, uint64_t(0));
+  Value *const numY = CreateExtractElement(numWorkgroups, 1);
+  Value *const linearId = CreateAdd(CreateMul(CreateExtractElement(workgroupId, 1), numX),
+                                    CreateExtractElement(workgroupId, uint64_t(0)));
+
+  Value *newX = nullptr;
+  Value *newY = nullptr;
+  if (swizzle == WorkgroupIdSwizzle::ColumnStrips) {
+    // Each strip is tileSize workgroups wide (narrower at the right edge of the grid) and the whole grid high.
+    Value *const stripArea = CreateMul(tileSize, numY);
+    Value *const strip = CreateUDiv(linearId, stripArea);
+    Value *const idInStrip = CreateSub(linearId, CreateMul(strip, stripArea));
+    Value *const stripX = CreateMul(strip, tileSize);
+    Value *const width = createUMin(tileSize, CreateSub(numX, stripX));
+    newX = CreateAdd(stripX, CreateURem(idInStrip, width));
+    newY = CreateUDiv(idInStrip, width);
+  } else {
+    // Each row of tiles is tileSize workgroups high (lower at the bottom edge of the grid) and the whole grid wide.
+    Value *const tileRowArea = CreateMul(tileSize, numX);
+    Value *const tileRow = CreateUDiv(linearId, tileRowArea);
+    Value *const idInTileRow = CreateSub(linearId, CreateMul(tileRow, tileRowArea));
+    Value *const tileY = CreateMul(tileRow, tileSize);
+    Value *const height = createUMin(tileSize, CreateSub(numY, tileY));
+
+    // Each tile in the row is tileSize workgroups wide (narrower at the right edge of the grid).
+    Value *const tileArea = CreateMul(tileSize, height);
+    Value *const tileCol = CreateUDiv(idInTileRow, tileArea);
+    Value *const idInTile = CreateSub(idInTileRow, CreateMul(tileCol, tileArea));
+    Value *const tileX = CreateMul(tileCol, tileSize);
+    Value *const width = createUMin(tileSize, CreateSub(numX, tileX));
+    Value *xInTile = CreateURem(idInTile, width);
+    Value *yInTile = CreateUDiv(idInTile, width);
+
+    if (swizzle == WorkgroupIdSwizzle::Morton) {
+      // De-interleave the bits of the index within the tile. Z-order only covers full tiles, so partial tiles at the
+      // edges of the grid keep the row-major order.
+      Value *mortonX = getInt32(0);
+      Value *mortonY = getInt32(0);
+      for (unsigned bit = 0; bit != Log2_32(size); ++bit) {
+        mortonX = CreateOr(mortonX, CreateAnd(CreateLShr(idInTile, bit), 1U << bit));
+        mortonY = CreateOr(mortonY, CreateAnd(CreateLShr(idInTile, bit + 1), 1U << bit));
+      }
+      Value *const isFullTile = CreateAnd(CreateICmpEQ(width, tileSize), CreateICmpEQ(height, tileSize));
+      xInTile = CreateSelect(isFullTile, mortonX, xInTile);
+      yInTile = CreateSelect(isFullTile, mortonY, yInTile);
+    }
+
+    newX = CreateAdd(tileX, xInTile);
+    newY = CreateAdd(tileY, yInTile);
+  }
+
+  workgroupId = CreateInsertElement(workgroupId, newX, uint64_t(0));
+  return CreateInsertElement(workgroupId, newY, 1);
+}
+
 // =====================================================================================================================
 // Read vertex shader input
 //
@@ -291,6 +291,10 @@ Value *SubgroupBuilder::CreateSubgroupBallotFindMsb(Value *const value, const Tw
 // @param index : The index to shuffle from.
 // @param instName : Name to give final instruction.
 Value *SubgroupBuilder::CreateSubgroupShuffle(Value *const value, Value *const index, const Twine &instName) {
+  // A constant index reads the same invocation in every lane, which is just a broadcast.
+  if (isa<Constant>(index))
+    return CreateSubgroupBroadcast(value, index, instName);
+
   if (supportBPermute()) {
     auto mapFunc = [](Builder &builder, ArrayRef<Value *> mappedArgs, ArrayRef<Value *> passthroughArgs) -> Value * {
       return builder.CreateIntrinsic(Intrinsic::amdgcn_ds_bpermute, {}, {passthroughArgs[0], mappedArgs[0]});
@@ -454,77 +458,78 @@ Value *SubgroupBuilder::CreateSubgroupClusteredReduction(GroupArithOp groupArith
 
     // Perform The group arithmetic operation between adjacent lanes in the subgroup, with all masks and rows enabled
     // (0xF).
-    result = CreateSelect(
-        CreateICmpUGE(clusterSize, getInt32(2)),
-        createGroupArithmeticOperation(groupArithOp, result,
-                                       createDppUpdate(identity, result, DppCtrl::DppQuadPerm1032, 0xF, 0xF, 0)),
-        result);
+    result = createClusterStep(clusterSize, 2, false, result, [&] {
+      return createGroupArithmeticOperation(groupArithOp, result,
+                                            createDppUpdate(identity, result, DppCtrl::DppQuadPerm1032, 0xF, 0xF, 0));
+    });
 
     // Perform The group arithmetic operation between N <-> N+2 lanes in the subgroup, with all masks and rows enabled
     // (0xF).
-    result = CreateSelect(
-        CreateICmpUGE(clusterSize, getInt32(4)),
-        createGroupArithmeticOperation(groupArithOp, result,
-                                       createDppUpdate(identity, result, DppCtrl::DppQuadPerm2301, 0xF, 0xF, 0)),
-        result);
+    result = createClusterStep(clusterSize, 4, false, result, [&] {
+      return createGroupArithmeticOperation(groupArithOp, result,
+                                            createDppUpdate(identity, result, DppCtrl::DppQuadPerm2301, 0xF, 0xF, 0));
+    });
 
     // Use a row half mirror to make all values in a cluster of 8 the same, with all masks and rows enabled (0xF).
-    result = CreateSelect(
-        CreateICmpUGE(clusterSize, getInt32(8)),
-        createGroupArithmeticOperation(groupArithOp, result,
-                                       createDppUpdate(identity, result, DppCtrl::DppRowHalfMirror, 0xF, 0xF, 0)),
-        result);
+    result = createClusterStep(clusterSize, 8, false, result, [&] {
+      return createGroupArithmeticOperation(groupArithOp, result,
+                                            createDppUpdate(identity, result, DppCtrl::DppRowHalfMirror, 0xF, 0xF, 0));
+    });
 
     // Use a row mirror to make all values in a cluster of 16 the same, with all masks and rows enabled (0xF).
-    result =
-        CreateSelect(CreateICmpUGE(clusterSize, getInt32(16)),
-                     createGroupArithmeticOperation(
-                         groupArithOp, result, createDppUpdate(identity, result, DppCtrl::DppRowMirror, 0xF, 0xF, 0)),
-                     result);
+    result = createClusterStep(clusterSize, 16, false, result, [&] {
+      return createGroupArithmeticOperation(groupArithOp, result,
+                                            createDppUpdate(identity, result, DppCtrl::DppRowMirror, 0xF, 0xF, 0));
+    });
 
     if (supportPermLaneDpp()) {
-      // Use a permute lane to cross rows (row 1 <-> row 0, row 3 <-> row 2).
-      result = CreateSelect(
-          CreateICmpUGE(clusterSize, getInt32(32)),
-          createGroupArithmeticOperation(groupArithOp, result,
-                                         createPermLaneX16(result, result, UINT32_MAX, UINT32_MAX, true, false)),
-          result);
-
-      Value *const broadcast31 = CreateSubgroupBroadcast(result, getInt32(31), instName);
-      Value *const broadcast63 = CreateSubgroupBroadcast(result, getInt32(63), instName);
-
-      // Combine broadcast from the 31st and 63rd for the final result.
-      result = CreateSelect(CreateICmpEQ(clusterSize, getInt32(64)),
-                            createGroupArithmeticOperation(groupArithOp, broadcast31, broadcast63), result);
+      auto constClusterSize = dyn_cast<ConstantInt>(clusterSize);
+      if (getShaderSubgroupSize() == 32 && constClusterSize && constClusterSize->getZExtValue() >= 32) {
+        // The cluster is the whole wave32 subgroup, so combine its two rows with a readlane tree instead of crossing
+        // them with a permute lane. This gives a wave-uniform result that later uses can keep in SGPRs.
+        Value *const broadcast15 = CreateSubgroupBroadcast(result, getInt32(15), instName);
+        Value *const broadcast31 = CreateSubgroupBroadcast(result, getInt32(31), instName);
+        result = createGroupArithmeticOperation(groupArithOp, broadcast15, broadcast31);
+      } else {
+        // Use a permute lane to cross rows (row 1 <-> row 0, row 3 <-> row 2).
+        result = createClusterStep(clusterSize, 32, false, result, [&] {
+          return createGroupArithmeticOperation(groupArithOp, result,
+                                                createPermLaneX16(result, result, UINT32_MAX, UINT32_MAX, true, false));
+        });
+
+        // Combine broadcast from the 31st and 63rd for the final result.
+        result = createClusterStep(clusterSize, 64, true, result, [&] {
+          Value *const broadcast31 = CreateSubgroupBroadcast(result, getInt32(31), instName);
+          Value *const broadcast63 = CreateSubgroupBroadcast(result, getInt32(63), instName);
+          return createGroupArithmeticOperation(groupArithOp, broadcast31, broadcast63);
+        });
+      }
     } else {
       // Use a row broadcast to move the 15th element in each cluster of 16 to the next cluster. The row mask is
       // set to 0xa (0b1010) so that only the 2nd and 4th clusters of 16 perform the calculation.
-      result = CreateSelect(
-          CreateICmpUGE(clusterSize, getInt32(32)),
-          createGroupArithmeticOperation(groupArithOp, result,
-                                         createDppUpdate(identity, result, DppCtrl::DppRowBcast15, 0xA, 0xF, 0)),
-          result);
+      result = createClusterStep(clusterSize, 32, false, result, [&] {
+        return createGroupArithmeticOperation(groupArithOp, result,
+                                              createDppUpdate(identity, result, DppCtrl::DppRowBcast15, 0xA, 0xF, 0));
+      });
 
       // Use a row broadcast to move the 31st element from the lower cluster of 32 to the upper cluster. The row
       // mask is set to 0x8 (0b1000) so that only the upper cluster of 32 perform the calculation.
-      result = CreateSelect(
-          CreateICmpEQ(clusterSize, getInt32(64)),
-          createGroupArithmeticOperation(groupArithOp, result,
-                                         createDppUpdate(identity, result, DppCtrl::DppRowBcast31, 0x8, 0xF, 0)),
-          result);
-
-      Value *const broadcast31 = CreateSubgroupBroadcast(result, getInt32(31), instName);
-      Value *const broadcast63 = CreateSubgroupBroadcast(result, getInt32(63), instName);
+      result = createClusterStep(clusterSize, 64, true, result, [&] {
+        Value *const bcast31 = createDppUpdate(identity, result, DppCtrl::DppRowBcast31, 0x8, 0xF, 0);
+        Value *const upperResult = createGroupArithmeticOperation(groupArithOp, result, bcast31);
 
-      // If the cluster size is 64 we always read the value from the last invocation in the subgroup.
-      result = CreateSelect(CreateICmpEQ(clusterSize, getInt32(64)), broadcast63, result);
-
-      Value *const laneIdLessThan32 = CreateICmpULT(CreateSubgroupMbcnt(getInt64(UINT64_MAX), ""), getInt32(32));
+        // If the cluster size is 64 we always read the value from the last invocation in the subgroup.
+        return CreateSubgroupBroadcast(upperResult, getInt32(63), instName);
+      });
 
       // If the cluster size is 32 we need to check where our invocation is in the subgroup, and conditionally use
       // invocation 31 or 63's value.
-      result = CreateSelect(CreateICmpEQ(clusterSize, getInt32(32)),
-                            CreateSelect(laneIdLessThan32, broadcast31, broadcast63), result);
+      result = createClusterStep(clusterSize, 32, true, result, [&] {
+        Value *const broadcast31 = CreateSubgroupBroadcast(result, getInt32(31), instName);
+        Value *const broadcast63 = CreateSubgroupBroadcast(result, getInt32(63), instName);
+        Value *const laneIdLessThan32 = CreateICmpULT(CreateSubgroupMbcnt(getInt64(UINT64_MAX), ""), getInt32(32));
+        return CreateSelect(laneIdLessThan32, broadcast31, broadcast63);
+      });
     }
 
     // Finish the WWM section by calling the intrinsic.
@@ -603,74 +608,68 @@ Value *SubgroupBuilder::CreateSubgroupClusteredInclusive(GroupArithOp groupArith
     Value *const setInactive = createSetInactive(value, identity);
 
     // The DPP operation has all rows active and all banks in the rows active (0xF).
-    Value *result = CreateSelect(
-        CreateICmpUGE(clusterSize, getInt32(2)),
-        createGroupArithmeticOperation(groupArithOp, setInactive,
-                                       createDppUpdate(identity, setInactive, DppCtrl::DppRowSr1, 0xF, 0xF, 0)),
-        setInactive);
+    Value *result = createClusterStep(clusterSize, 2, false, setInactive, [&] {
+      return createGroupArithmeticOperation(groupArithOp, setInactive,
+                                            createDppUpdate(identity, setInactive, DppCtrl::DppRowSr1, 0xF, 0xF, 0));
+    });
 
     // The DPP operation has all rows active and all banks in the rows active (0xF).
-    result =
-        CreateSelect(CreateICmpUGE(clusterSize, getInt32(4)),
-                     createGroupArithmeticOperation(
-                         groupArithOp, result, createDppUpdate(identity, setInactive, DppCtrl::DppRowSr2, 0xF, 0xF, 0)),
-                     result);
+    result = createClusterStep(clusterSize, 4, false, result, [&] {
+      return createGroupArithmeticOperation(groupArithOp, result,
+                                            createDppUpdate(identity, setInactive, DppCtrl::DppRowSr2, 0xF, 0xF, 0));
+    });
 
     // The DPP operation has all rows active and all banks in the rows active (0xF).
-    result =
-        CreateSelect(CreateICmpUGE(clusterSize, getInt32(4)),
-                     createGroupArithmeticOperation(
-                         groupArithOp, result, createDppUpdate(identity, setInactive, DppCtrl::DppRowSr3, 0xF, 0xF, 0)),
-                     result);
+    result = createClusterStep(clusterSize, 4, false, result, [&] {
+      return createGroupArithmeticOperation(groupArithOp, result,
+                                            createDppUpdate(identity, setInactive, DppCtrl::DppRowSr3, 0xF, 0xF, 0));
+    });
 
     // The DPP operation has all rows active (0xF) and the top 3 banks active (0xe, 0b1110) to make sure that in
     // each cluster of 16, only the top 12 lanes perform the operation.
-    result = CreateSelect(CreateICmpUGE(clusterSize, getInt32(8)),
-                          createGroupArithmeticOperation(
-                              groupArithOp, result, createDppUpdate(identity, result, DppCtrl::DppRowSr4, 0xF, 0xE, 0)),
-                          result);
+    result = createClusterStep(clusterSize, 8, false, result, [&] {
+      return createGroupArithmeticOperation(groupArithOp, result,
+                                            createDppUpdate(identity, result, DppCtrl::DppRowSr4, 0xF, 0xE, 0));
+    });
 
     // The DPP operation has all rows active (0xF) and the top 2 banks active (0xc, 0b1100) to make sure that in
     // each cluster of 16, only the top 8 lanes perform the operation.
-    result = CreateSelect(CreateICmpUGE(clusterSize, getInt32(16)),
-                          createGroupArithmeticOperation(
-                              groupArithOp, result, createDppUpdate(identity, result, DppCtrl::DppRowSr8, 0xF, 0xC, 0)),
-                          result);
+    result = createClusterStep(clusterSize, 16, false, result, [&] {
+      return createGroupArithmeticOperation(groupArithOp, result,
+                                            createDppUpdate(identity, result, DppCtrl::DppRowSr8, 0xF, 0xC, 0));
+    });
 
     if (supportPermLaneDpp()) {
       Value *const threadMask = createThreadMask();
 
-      Value *const maskedPermLane =
-          createThreadMaskedSelect(threadMask, 0xFFFF0000FFFF0000,
-                                   createPermLaneX16(result, result, UINT32_MAX, UINT32_MAX, true, false), identity);
-
       // Use a permute lane to cross rows (row 1 <-> row 0, row 3 <-> row 2).
-      result = CreateSelect(CreateICmpUGE(clusterSize, getInt32(32)),
-                            createGroupArithmeticOperation(groupArithOp, result, maskedPermLane), result);
-
-      Value *const broadcast31 = CreateSubgroupBroadcast(result, getInt32(31), instName);
-
-      Value *const maskedBroadcast = createThreadMaskedSelect(threadMask, 0xFFFFFFFF00000000, broadcast31, identity);
+      result = createClusterStep(clusterSize, 32, false, result, [&] {
+        Value *const maskedPermLane =
+            createThreadMaskedSelect(threadMask, 0xFFFF0000FFFF0000,
+                                     createPermLaneX16(result, result, UINT32_MAX, UINT32_MAX, true, false), identity);
+        return createGroupArithmeticOperation(groupArithOp, result, maskedPermLane);
+      });
 
       // Combine broadcast of 31 with the top two rows only.
-      result = CreateSelect(CreateICmpEQ(clusterSize, getInt32(64)),
-                            createGroupArithmeticOperation(groupArithOp, result, maskedBroadcast), result);
+      result = createClusterStep(clusterSize, 64, true, result, [&] {
+        Value *const broadcast31 = CreateSubgroupBroadcast(result, getInt32(31), instName);
+        Value *const maskedBroadcast = createThreadMaskedSelect(threadMask, 0xFFFFFFFF00000000, broadcast31, identity);
+        return createGroupArithmeticOperation(groupArithOp, result, maskedBroadcast);
+      });
     } else {
       // The DPP operation has a row mask of 0xa (0b1010) so only the 2nd and 4th clusters of 16 perform the
       // operation.
-      result = CreateSelect(
-          CreateICmpUGE(clusterSize, getInt32(32)),
-          createGroupArithmeticOperation(groupArithOp, result,
-                                         createDppUpdate(identity, result, DppCtrl::DppRowBcast15, 0xA, 0xF, 0)),
-          result);
+      result = createClusterStep(clusterSize, 32, false, result, [&] {
+        return createGroupArithmeticOperation(groupArithOp, result,
+                                              createDppUpdate(identity, result, DppCtrl::DppRowBcast15, 0xA, 0xF, 0));
+      });
 
       // The DPP operation has a row mask of 0xc (0b1100) so only the 3rd and 4th clusters of 16 perform the
       // operation.
-      result = CreateSelect(
-          CreateICmpEQ(clusterSize, getInt32(64)),
-          createGroupArithmeticOperation(groupArithOp, result,
-                                         createDppUpdate(identity, result, DppCtrl::DppRowBcast31, 0xC, 0xF, 0)),
-          result);
+      result = createClusterStep(clusterSize, 64, true, result, [&] {
+        return createGroupArithmeticOperation(groupArithOp, result,
+                                              createDppUpdate(identity, result, DppCtrl::DppRowBcast31, 0xC, 0xF, 0));
+      });
     }
 
     // Finish the WWM section by calling the intrinsic.
@@ -780,74 +779,68 @@ Value *SubgroupBuilder::CreateSubgroupClusteredExclusive(GroupArithOp groupArith
     }
 
     // The DPP operation has all rows active and all banks in the rows active (0xF).
-    Value *result = CreateSelect(
-        CreateICmpUGE(clusterSize, getInt32(2)),
-        createGroupArithmeticOperation(groupArithOp, shiftRight,
-                                       createDppUpdate(identity, shiftRight, DppCtrl::DppRowSr1, 0xF, 0xF, 0)),
-        shiftRight);
+    Value *result = createClusterStep(clusterSize, 2, false, shiftRight, [&] {
+      return createGroupArithmeticOperation(groupArithOp, shiftRight,
+                                            createDppUpdate(identity, shiftRight, DppCtrl::DppRowSr1, 0xF, 0xF, 0));
+    });
 
     // The DPP operation has all rows active and all banks in the rows active (0xF).
-    result =
-        CreateSelect(CreateICmpUGE(clusterSize, getInt32(4)),
-                     createGroupArithmeticOperation(
-                         groupArithOp, result, createDppUpdate(identity, shiftRight, DppCtrl::DppRowSr2, 0xF, 0xF, 0)),
-                     result);
+    result = createClusterStep(clusterSize, 4, false, result, [&] {
+      return createGroupArithmeticOperation(groupArithOp, result,
+                                            createDppUpdate(identity, shiftRight, DppCtrl::DppRowSr2, 0xF, 0xF, 0));
+    });
 
     // The DPP operation has all rows active and all banks in the rows active (0xF).
-    result =
-        CreateSelect(CreateICmpUGE(clusterSize, getInt32(4)),
-                     createGroupArithmeticOperation(
-                         groupArithOp, result, createDppUpdate(identity, shiftRight, DppCtrl::DppRowSr3, 0xF, 0xF, 0)),
-                     result);
+    result = createClusterStep(clusterSize, 4, false, result, [&] {
+      return createGroupArithmeticOperation(groupArithOp, result,
+                                            createDppUpdate(identity, shiftRight, DppCtrl::DppRowSr3, 0xF, 0xF, 0));
+    });
 
     // The DPP operation has all rows active (0xF) and the top 3 banks active (0xe, 0b1110) to make sure that in
     // each cluster of 16, only the top 12 lanes perform the operation.
-    result = CreateSelect(CreateICmpUGE(clusterSize, getInt32(8)),
-                          createGroupArithmeticOperation(
-                              groupArithOp, result, createDppUpdate(identity, result, DppCtrl::DppRowSr4, 0xF, 0xE, 0)),
-                          result);
+    result = createClusterStep(clusterSize, 8, false, result, [&] {
+      return createGroupArithmeticOperation(groupArithOp, result,
+                                            createDppUpdate(identity, result, DppCtrl::DppRowSr4, 0xF, 0xE, 0));
+    });
 
     // The DPP operation has all rows active (0xF) and the top 2 banks active (0xc, 0b1100) to make sure that in
     // each cluster of 16, only the top 8 lanes perform the operation.
-    result = CreateSelect(CreateICmpUGE(clusterSize, getInt32(16)),
-                          createGroupArithmeticOperation(
-                              groupArithOp, result, createDppUpdate(identity, result, DppCtrl::DppRowSr8, 0xF, 0xC, 0)),
-                          result);
+    result = createClusterStep(clusterSize, 16, false, result, [&] {
+      return createGroupArithmeticOperation(groupArithOp, result,
+                                            createDppUpdate(identity, result, DppCtrl::DppRowSr8, 0xF, 0xC, 0));
+    });
 
     if (supportPermLaneDpp()) {
       Value *const threadMask = createThreadMask();
 
-      Value *const maskedPermLane =
-          createThreadMaskedSelect(threadMask, 0xFFFF0000FFFF0000,
-                                   createPermLaneX16(result, result, UINT32_MAX, UINT32_MAX, true, false), identity);
-
       // Use a permute lane to cross rows (row 1 <-> row 0, row 3 <-> row 2).
-      result = CreateSelect(CreateICmpUGE(clusterSize, getInt32(32)),
-                            createGroupArithmeticOperation(groupArithOp, result, maskedPermLane), result);
-
-      Value *const broadcast31 = CreateSubgroupBroadcast(result, getInt32(31), instName);
-
-      Value *const maskedBroadcast = createThreadMaskedSelect(threadMask, 0xFFFFFFFF00000000, broadcast31, identity);
+      result = createClusterStep(clusterSize, 32, false, result, [&] {
+        Value *const maskedPermLane =
+            createThreadMaskedSelect(threadMask, 0xFFFF0000FFFF0000,
+                                     createPermLaneX16(result, result, UINT32_MAX, UINT32_MAX, true, false), identity);
+        return createGroupArithmeticOperation(groupArithOp, result, maskedPermLane);
+      });
 
       // Combine broadcast of 31 with the top two rows only.
-      result = CreateSelect(CreateICmpEQ(clusterSize, getInt32(64)),
-                            createGroupArithmeticOperation(groupArithOp, result, maskedBroadcast), result);
+      result = createClusterStep(clusterSize, 64, true, result, [&] {
+        Value *const broadcast31 = CreateSubgroupBroadcast(result, getInt32(31), instName);
+        Value *const maskedBroadcast = createThreadMaskedSelect(threadMask, 0xFFFFFFFF00000000, broadcast31, identity);
+        return createGroupArithmeticOperation(groupArithOp, result, maskedBroadcast);
+      });
     } else {
       // The DPP operation has a row mask of 0xa (0b1010) so only the 2nd and 4th clusters of 16 perform the
       // operation.
-      result = CreateSelect(
-          CreateICmpUGE(clusterSize, getInt32(32)),
-          createGroupArithmeticOperation(groupArithOp, result,
-                                         createDppUpdate(identity, result, DppCtrl::DppRowBcast15, 0xA, 0xF, 0)),
-          result);
+      result = createClusterStep(clusterSize, 32, false, result, [&] {
+        return createGroupArithmeticOperation(groupArithOp, result,
+                                              createDppUpdate(identity, result, DppCtrl::DppRowBcast15, 0xA, 0xF, 0));
+      });
 
       // The DPP operation has a row mask of 0xc (0b1100) so only the 3rd and 4th clusters of 16 perform the
       // operation.
-      result = CreateSelect(
-          CreateICmpEQ(clusterSize, getInt32(64)),
-          createGroupArithmeticOperation(groupArithOp, result,
-                                         createDppUpdate(identity, result, DppCtrl::DppRowBcast31, 0xC, 0xF, 0)),
-          result);
+      result = createClusterStep(clusterSize, 64, true, result, [&] {
+        return createGroupArithmeticOperation(groupArithOp, result,
+                                              createDppUpdate(identity, result, DppCtrl::DppRowBcast31, 0xC, 0xF, 0));
+      });
     }
 
     // Finish the WWM section by calling the intrinsic.
@@ -1395,6 +1388,29 @@ Value *SubgroupBuilder::createThreadMaskedSelect(Value *const threadMask, uint64
   return CreateSelect(CreateICmpNE(CreateAnd(threadMask, andMaskVal), zero), value1, value2);
 }
 
+// =====================================================================================================================
+// Create one step of a clustered scan or reduction, which only applies to clusters of at least (or, if exactSize,
+// exactly) minClusterSize invocations. With a constant cluster size, which SPIR-V always gives us, the step is either
+// emitted unconditionally or not at all; otherwise it is selected against the previous result at run time.
+//
+// @param clusterSize : The cluster size.
+// @param minClusterSize : The cluster size from which the step applies.
+// @param exactSize : Whether the step applies to clusters of exactly minClusterSize only.
+// @param result : The result before this step.
+// @param createStep : Callback to emit the step, returning the result after it.
+Value *SubgroupBuilder::createClusterStep(Value *const clusterSize, unsigned minClusterSize, bool exactSize,
+                                          Value *const result, std::function<Value *()> createStep) {
+  if (auto constClusterSize = dyn_cast<ConstantInt>(clusterSize)) {
+    uint64_t size = constClusterSize->getZExtValue();
+    bool applies = exactSize ? size == minClusterSize : size >= minClusterSize;
+    return applies ? createStep() : result;
+  }
+
+  Value *const applies = exactSize ? CreateICmpEQ(clusterSize, getInt32(minClusterSize))
+                                   : CreateICmpUGE(clusterSize, getInt32(minClusterSize));
+  return CreateSelect(applies, createStep(), result);
+}
+
 // =====================================================================================================================
 // Do group ballot, turning a per-lane boolean value (in a VGPR) into a subgroup-wide shared SGPR.
 //
@@ -214,6 +214,14 @@ Module *FetchShader::generate() {
   Value *result = ret->getOperand(0);
   BuilderBase builder(ret);
 
+  // Plan loads shared between inputs.
+  SmallVector<const VertexInputDescription *, 8> descriptions;
+  for (const VertexInputDescription *description : m_fetchDescriptions) {
+    if (description)
+      descriptions.push_back(description);
+  }
+  vertexFetch->planFetches(descriptions);
+
   for (unsigned idx = 0; idx != m_fetches.size(); ++idx) {
     const auto &fetch = m_fetches[idx];
     const VertexInputDescription *description = m_fetchDescriptions[idx];
@@ -49,6 +49,7 @@ void initializeLowerVertexFetchPass(PassRegistry &);
 void initializePatchBufferOpPass(PassRegistry &);
 void initializePatchCheckShaderCachePass(PassRegistry &);
 void initializePatchCopyShaderPass(PassRegistry &);
+void initializePatchDescriptorLoadOptPass(PassRegistry &);
 void initializePatchEntryPointMutatePass(PassRegistry &);
 void initializePatchInOutImportExportPass(PassRegistry &);
 void initializePatchLlvmIrInclusionPass(PassRegistry &);
@@ -59,6 +60,7 @@ void initializePatchPeepholeOptPass(PassRegistry &);
 void initializePatchPreparePipelineAbiPass(PassRegistry &);
 void initializePatchResourceCollectPass(PassRegistry &);
 void initializePatchSetupTargetFeaturesPass(PassRegistry &);
+void initializePatchWaterfallFusionPass(PassRegistry &);
 void initializePatchWorkaroundsPass(PassRegistry &);
 
 } // namespace llvm
@@ -76,6 +78,7 @@ inline static void initializePatchPasses(llvm::PassRegistry &passRegistry) {
   initializePatchBufferOpPass(passRegistry);
   initializePatchCheckShaderCachePass(passRegistry);
   initializePatchCopyShaderPass(passRegistry);
+  initializePatchDescriptorLoadOptPass(passRegistry);
   initializePatchEntryPointMutatePass(passRegistry);
   initializePatchInOutImportExportPass(passRegistry);
   initializePatchLlvmIrInclusionPass(passRegistry);
@@ -86,6 +89,7 @@ inline static void initializePatchPasses(llvm::PassRegistry &passRegistry) {
   initializePatchPreparePipelineAbiPass(passRegistry);
   initializePatchResourceCollectPass(passRegistry);
   initializePatchSetupTargetFeaturesPass(passRegistry);
+  initializePatchWaterfallFusionPass(passRegistry);
   initializePatchWorkaroundsPass(passRegistry);
 }
 
@@ -94,6 +98,7 @@ llvm::ModulePass *createLowerVertexFetch();
 llvm::FunctionPass *createPatchBufferOp();
 PatchCheckShaderCache *createPatchCheckShaderCache();
 llvm::ModulePass *createPatchCopyShader();
+llvm::FunctionPass *createPatchDescriptorLoadOpt();
 llvm::ModulePass *createPatchEntryPointMutate();
 llvm::ModulePass *createPatchInOutImportExport();
 llvm::ModulePass *createPatchLlvmIrInclusion();
@@ -104,6 +109,7 @@ llvm::FunctionPass *createPatchPeepholeOpt();
 llvm::ModulePass *createPatchPreparePipelineAbi(bool onlySetCallingConvs);
 llvm::ModulePass *createPatchResourceCollect();
 llvm::ModulePass *createPatchSetupTargetFeatures();
+llvm::FunctionPass *createPatchWaterfallFusion();
 llvm::ModulePass *createPatchWorkarounds();
 
 class PipelineState;
@@ -133,6 +139,7 @@ protected:
 
 private:
   static void addOptimizationPasses(llvm::legacy::PassManager &passMgr);
+  static void addFastCompileOptimizationPasses(llvm::legacy::PassManager &passMgr);
 
   Patch() = delete;
   Patch(const Patch &) = delete;
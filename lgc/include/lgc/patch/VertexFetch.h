@@ -45,6 +45,10 @@ public:
   // Create a VertexFetch
   static VertexFetch *create(LgcContext *lgcContext);
 
+  // Plan buffer loads shared between the vertex inputs that are going to be fetched. This is optional; without it,
+  // each input is fetched by its own buffer loads.
+  virtual void planFetches(llvm::ArrayRef<const VertexInputDescription *> descriptions) = 0;
+
   // Generate code to fetch a vertex value
   virtual llvm::Value *fetchVertex(llvm::Type *inputTy, const VertexInputDescription *description, unsigned location,
                                    unsigned compIdx, BuilderBase &builder) = 0;
@@ -61,6 +61,18 @@ namespace Abi {
 // Name prefix of the section where our pipeline binaries store extra information e.g. LLVM IR.
 static constexpr char AmdGpuCommentName[] = ".AMDGPU.comment.";
 
+// Name of the section where our pipeline binaries store LLVM IR as bitcode.
+static constexpr char AmdGpuCommentLlvmBcName[] = ".AMDGPU.comment.llvmbc";
+
+// Header of each module in the .AMDGPU.comment.llvmbc section. The module data follows the header, padded to a
+// multiple of 4 bytes, so that the section can hold a sequence of modules, as it does after two ELFs are merged.
+struct LlvmBcHeader {
+  uint32_t magic;    // LlvmBcMagic
+  uint32_t dataSize; // Byte size of the bitcode that follows, excluding padding
+};
+
+static constexpr uint32_t LlvmBcMagic = 0x43424C4C; // "LLBC"
+
 // Symbol names for shader entry-points
 static constexpr char AmdGpuLsEntryName[] = "_amdgpu_ls_main";
 static constexpr char AmdGpuHsEntryName[] = "_amdgpu_hs_main";
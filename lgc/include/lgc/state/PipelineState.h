@@ -116,6 +116,18 @@ struct NggControl {
   Util::Abi::PrimShaderCbLayout primShaderTable; // Primitive shader table (only some registers are used)
 };
 
+// =====================================================================================================================
+// Automatic wave size selection for one shader stage (GFX10+), and the inputs it was based on
+struct WaveSizeSelection {
+  unsigned waveSize;         // Selected wave size; 0 if no selection was made for the stage
+  unsigned defaultWaveSize;  // Wave size chosen by the fixed per-stage rules
+  unsigned vgprEstimate;     // Estimated VGPRs per lane
+  unsigned ldsSize;          // LDS bytes used per workgroup
+  unsigned divergentPercent; // Percentage of instructions under possibly divergent control flow
+  unsigned score32;          // Modeled throughput with wave32 (useful lanes in flight per SIMD)
+  unsigned score64;          // Modeled throughput with wave64
+};
+
 // =====================================================================================================================
 // The middle-end implementation of PipelineState, a subclass of Pipeline.
 class PipelineState final : public Pipeline {
@@ -140,6 +152,9 @@ public:
   // Set per-shader options
   void setShaderOptions(ShaderStage stage, const ShaderOptions &options) override final;
 
+  // Set function to check whether the compile has been cancelled
+  void setCancelCheck(std::function<bool()> cancelCheck) override final { m_cancelCheck = cancelCheck; }
+
   // Set device index
   void setDeviceIndex(unsigned deviceIndex) override final { m_deviceIndex = deviceIndex; }
 
@@ -171,6 +186,9 @@ public:
   // Get a textual error message for the last recoverable error
   llvm::StringRef getLastError() override final;
 
+  // Get whether the last generate() was stopped by the cancel check
+  bool wasCancelled() const override final { return m_cancelled; }
+
   // Compute the ExportFormat (as an opaque int) of the specified color export location with the specified output
   // type. Only the number of elements of the type is significant.
   unsigned computeExportFormat(llvm::Type *outputTy, unsigned location) override final;
@@ -266,9 +284,24 @@ public:
   // Check whether input/output packing can be used
   bool canPackInOut() const { return m_packInOut; }
 
+  // Check whether the generic inputs of the specified shader stage are packed
+  bool canPackInput(ShaderStage shaderStage);
+
+  // Check whether the generic outputs of the specified shader stage are packed
+  bool canPackOutput(ShaderStage shaderStage);
+
   // Gets wave size for the specified shader stage
   unsigned getShaderWaveSize(ShaderStage stage);
 
+  // Gets the wave size chosen by the fixed per-stage rules for the specified shader stage
+  unsigned getDefaultShaderWaveSize(ShaderStage stage);
+
+  // Set/get the automatic wave size selection for the specified shader stage
+  void setWaveSizeSelection(ShaderStage stage, const WaveSizeSelection &selection) {
+    m_waveSizeSelection[stage] = selection;
+  }
+  const WaveSizeSelection &getWaveSizeSelection(ShaderStage stage) const { return m_waveSizeSelection[stage]; }
+
   // Get NGG control settings
   NggControl *getNggControl() { return &m_nggControl; }
 
@@ -415,11 +448,15 @@ private:
   std::string m_lastError;                              // Error to be reported by getLastError()
   bool m_noReplayer = false;                            // True if no BuilderReplayer needed
   bool m_emitLgc = false;                               // Whether -emit-lgc is on
+  bool m_irLinked = false;                              // Whether irLink() was called, so that this object (rather
+                                                        //  than IR metadata) holds the pipeline state
   bool m_unlinked = false;                              // Whether generating an unlinked half-pipeline ELF
   unsigned m_stageMask = 0;                             // Mask of active shader stages
   bool m_computeLibrary = false;                        // Whether pipeline is in fact a compute library
   Options m_options = {};                               // Per-pipeline options
   std::vector<ShaderOptions> m_shaderOptions;           // Per-shader options
+  std::function<bool()> m_cancelCheck;                  // Function to check whether the compile has been cancelled
+  bool m_cancelled = false;                             // Whether the last generate() was stopped by m_cancelCheck
   std::unique_ptr<ResourceNode[]> m_allocUserDataNodes; // Allocated buffer for user data
   llvm::ArrayRef<ResourceNode> m_userDataNodes;         // Top-level user data node table
   llvm::MDString *m_resourceNodeTypeNames[unsigned(ResourceNodeType::Count)] = {};
@@ -439,6 +476,7 @@ private:
   std::unique_ptr<ResourceUsage> m_resourceUsage[ShaderStageCompute + 1] = {}; // Per-shader ResourceUsage
   std::unique_ptr<InterfaceData> m_interfaceData[ShaderStageCompute + 1] = {}; // Per-shader InterfaceData
   PalMetadata *m_palMetadata = nullptr;                                        // PAL metadata object
+  WaveSizeSelection m_waveSizeSelection[ShaderStageCompute + 1] = {};          // Per-shader wave size selection
 };
 
 // =====================================================================================================================
@@ -81,15 +81,15 @@ public:
   void record(llvm::Module *module);
 
   // Read shader modes (common and specific) from a shader IR module, but only if no modes have been set
-  // in this ShaderModes. This is used to handle the case that the shader module comes from an earlier
-  // shader compile, and it had its ShaderModes recorded into IR then.
+  // for that shader stage in this ShaderModes. This is used to handle the case that the shader module comes
+  // from an earlier shader compile, and it had its ShaderModes recorded into IR then.
   void readModesFromShader(llvm::Module *module, ShaderStage stage);
 
   // Read shader modes from IR metadata in a pipeline
   void readModesFromPipeline(llvm::Module *module);
 
 private:
-  bool m_anySet = false;                                             // Whether any Set*Mode method called
+  unsigned m_setStageMask = 0;                                       // Mask of stages with common modes set
   CommonShaderMode m_commonShaderModes[ShaderStageCompute + 1] = {}; // Per-shader FP modes
   TessellationMode m_tessellationMode = {};                          // Tessellation mode
   GeometryShaderMode m_geometryShaderMode = {};                      // Geometry shader mode
@@ -58,6 +58,20 @@ ShaderStage getShaderStage(const llvm::Function *func);
 // Determine whether the function is a shader entry-point.
 bool isShaderEntryPoint(const llvm::Function *func);
 
+// Seed the inter-shader data hash (!llpc.hash metadata) of a function with its input shader hash. Only functions that
+// have been seeded track the inter-shader data used to compile them.
+void setShaderHash(llvm::Function *func, llvm::ArrayRef<uint64_t> hash);
+
+// Update the inter-shader data hash of a function with data obtained from other shader stages, computing
+// h_new = h(h_old | data). Does nothing if the function is not tracking its hash.
+void updateShaderHash(llvm::Function *func, llvm::ArrayRef<uint8_t> data);
+
+// Get the inter-shader data hash of a function. Returns false if the function is not tracking its hash.
+bool getShaderHash(const llvm::Function *func, llvm::MutableArrayRef<uint64_t> hash);
+
+// Stop tracking the inter-shader data hash of a function, removing its metadata.
+void clearShaderHash(llvm::Function *func);
+
 // Gets name string of the abbreviation for the specified shader stage
 const char *getShaderStageAbbreviation(ShaderStage shaderStage);
 
@@ -0,0 +1,84 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2020 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  WaveSizeHeuristic.h
+ * @brief LLPC header file: contains declaration of class lgc::WaveSizeHeuristic
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "lgc/state/PipelineState.h"
+
+namespace llvm {
+class Function;
+class Module;
+} // namespace llvm
+
+namespace lgc {
+
+// Keys of the ".shaders.<stage>.wave_size_selection" map in PAL metadata, which reports the automatic wave size
+// selection for an API shader and the inputs it was based on.
+namespace WaveSizeSelectionKey {
+static constexpr char WaveSizeSelection[] = ".wave_size_selection";
+static constexpr char WaveSize[] = ".wave_size";
+static constexpr char DefaultWaveSize[] = ".default_wave_size";
+static constexpr char VgprEstimate[] = ".vgpr_estimate";
+static constexpr char LdsSize[] = ".lds_size";
+static constexpr char DivergentPercent[] = ".divergent_percent";
+static constexpr char Score32[] = ".score_wave32";
+static constexpr char Score64[] = ".score_wave64";
+}; // namespace WaveSizeSelectionKey
+
+// =====================================================================================================================
+// Selects wave32 or wave64 for each shader stage (GFX10+) from a model of its occupancy and SIMD utilization.
+//
+// This runs on the pipeline module before the Builder calls are replayed, since everything from Builder lowering
+// onwards depends on the wave size. It therefore works on a pre-register-allocation model of the shader.
+class WaveSizeHeuristic {
+public:
+  WaveSizeHeuristic(PipelineState *pipelineState) : m_pipelineState(pipelineState) {}
+
+  void run(llvm::Module &module);
+
+private:
+  // Statistics gathered from the functions of one shader stage
+  struct StageStats {
+    unsigned instCount;          // Number of instructions
+    unsigned divergentInstCount; // Number of instructions under possibly divergent control flow
+    unsigned vgprEstimate;       // Estimated VGPRs per lane
+    bool usesWaveSize;           // Whether the shader can observe the wave size
+  };
+
+  void collectStats(llvm::Function &func, StageStats &stats);
+  unsigned estimateVgprs(llvm::Function &func);
+  bool isWaveSizeObservable(llvm::Function &callee, llvm::CallInst &call);
+  unsigned getLdsSize(llvm::Module &module);
+  unsigned getScore(ShaderStage stage, unsigned waveSize, unsigned vgprs, unsigned ldsSize, unsigned divergentPercent);
+
+  PipelineState *m_pipelineState; // Pipeline state
+};
+
+} // namespace lgc
@@ -42,6 +42,7 @@ class BasicBlock;
 class CallInst;
 class Function;
 class Instruction;
+class Module;
 class PassRegistry;
 class Type;
 class Value;
@@ -95,4 +96,7 @@ bool isDontCareValue(llvm::Value *value);
 // type in a return value struct, ensuring it gets into VGPRs.
 llvm::Type *getVgprTy(llvm::Type *ty);
 
+// Appends a module, as bitcode with its LlvmBcHeader, to the contents of a .AMDGPU.comment.llvmbc section.
+void appendIncludedModule(llvm::Module &module, std::string &contents);
+
 } // namespace lgc
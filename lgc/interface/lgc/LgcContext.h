@@ -36,6 +36,7 @@ namespace llvm {
 
 class LLVMContext;
 class ModulePass;
+class raw_ostream;
 class raw_pwrite_stream;
 class TargetMachine;
 class Timer;
@@ -128,6 +129,28 @@ public:
   // Get pass manager cache
   PassManagerCache *getPassManagerCache();
 
+  // Get the name of the ELF section in which a pipeline ELF includes LLVM IR as bitcode (see -include-llvm-bc)
+  static llvm::StringRef getIncludedLlvmIrSectionName();
+
+  // Print the LLVM IR that a pipeline ELF includes as bitcode (see -include-llvm-bc) as LLVM IR text. This is done
+  // only on request, as it needs to parse each included module.
+  //
+  // @param elf : Pipeline ELF
+  // @param [out] out : Stream to print the LLVM IR to
+  // @returns : False if the ELF does not include any LLVM IR as bitcode, or it is malformed
+  static bool printIncludedLlvmIr(llvm::StringRef elf, llvm::raw_ostream &out);
+
+  // Merge the LLVM IR that a non-fragment ELF and a fragment ELF include as bitcode, for the pipeline ELF merged from
+  // them. The fragment shader is removed from the non-fragment ELF's modules, and everything else from the fragment
+  // ELF's modules, so that the merged section does not have a stale copy of either.
+  //
+  // @param nonFragmentSection : Contents of the .AMDGPU.comment.llvmbc section in the non-fragment ELF
+  // @param fragmentSection : Contents of the .AMDGPU.comment.llvmbc section in the fragment ELF
+  // @param [out] merged : Contents of the merged section
+  // @returns : False if either section is malformed
+  static bool mergeIncludedLlvmIr(llvm::StringRef nonFragmentSection, llvm::StringRef fragmentSection,
+                                  std::string &merged);
+
 private:
   LgcContext() = delete;
   LgcContext(const LgcContext &) = delete;
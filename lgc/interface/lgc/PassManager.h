@@ -31,6 +31,7 @@
 #pragma once
 
 #include "llvm/IR/LegacyPassManager.h"
+#include <functional>
 
 namespace lgc {
 
@@ -42,6 +43,14 @@ public:
   virtual ~PassManager() {}
   virtual void stop() = 0;
   virtual void setPassIndex(unsigned *passIndex) = 0;
+
+  // Set a function that is called between passes to check whether the compile has been cancelled (for example
+  // because its deadline has passed). Once it returns true, run() skips all remaining optional passes, so only the
+  // mandatory lowering and codegen passes still run, and isCancelled() returns true.
+  virtual void setCancelCheck(std::function<bool()> cancelCheck) = 0;
+  virtual bool isCancelled() const = 0;
+
+  virtual bool run(llvm::Module &module) = 0;
 };
 
 } // namespace lgc
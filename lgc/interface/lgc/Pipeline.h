@@ -87,6 +87,14 @@ enum class DenormalMode : unsigned {
   Preserve = 0x2,    ///< Denormals preserved
 };
 
+// Orders in which compute workgroup IDs can be remapped over the dispatch grid.
+enum class WorkgroupIdSwizzle : unsigned {
+  None = 0x0,         ///< No remapping; workgroups walk the grid in row-major order
+  Tiled = 0x1,        ///< Row-major order within NxN tiles of workgroups, tiles in row-major order
+  Morton = 0x2,       ///< Z-order (Morton) within NxN tiles of workgroups, tiles in row-major order
+  ColumnStrips = 0x3, ///< Row-major order within N-wide strips of workgroups, walking each strip down the grid
+};
+
 // If next available quad falls outside tile aligned region of size defined by this enumeration, the compiler
 // will force end of vector in the compiler to shader wavefront.
 // All of these values correspond to settings of WAVE_BREAK_REGION_SIZE in PA_SC_SHADER_CONTROL.
@@ -123,6 +131,8 @@ struct Options {
                                        //   ShadowDescriptorTableDisable to disable shadow descriptor tables
   unsigned allowNullDescriptor;        // Allow and give defined behavior for null descriptor
   unsigned disableImageResourceCheck;  // Don't do image resource type check
+  unsigned fastCompile;                // Minimize compile time: only a minimal set of middle-end optimizations, and
+                                       //   codegen at the lowest optimization level
 };
 
 // Middle-end per-shader options to pass to SetShaderOptions.
@@ -191,6 +201,12 @@ struct ShaderOptions {
 
   // Threshold to use for loops with DontUnroll hint. 0 to use llvm.loop.unroll.disable metadata.
   unsigned dontUnrollHintThreshold = 0;
+
+  // Order in which to remap the workgroup ID over the dispatch grid in a compute shader.
+  WorkgroupIdSwizzle workgroupIdSwizzle = WorkgroupIdSwizzle::None;
+
+  // Tile or strip width in workgroups for workgroupIdSwizzle. 0 for the default of 8.
+  unsigned workgroupIdSwizzleSize = 0;
 };
 
 // =====================================================================================================================
@@ -540,6 +556,9 @@ public:
   // Set per-shader options
   virtual void setShaderOptions(ShaderStage stage, const ShaderOptions &options) = 0;
 
+  // Set a function that generate() polls between passes to check whether the compile has been cancelled
+  virtual void setCancelCheck(std::function<bool()> cancelCheck) = 0;
+
   // Set the resource mapping nodes for the pipeline. "nodes" describes the user data
   // supplied to the shader as a hierarchical table (max two levels) of descriptors.
   // "immutableDescs" contains descriptors (currently limited to samplers), whose values are hard
@@ -618,7 +637,7 @@ public:
   // that got a hit in the cache.
   typedef std::function<unsigned(const llvm::Module *module,                         // [in] Module
                                  unsigned stageMask,                                 // Shader stage mask
-                                 llvm::ArrayRef<llvm::ArrayRef<uint8_t>> stageHashes // Per-stage hash of in/out usage
+                                 llvm::ArrayRef<llvm::ArrayRef<uint8_t>> stageHashes // Per-stage inter-shader data hash
                                  )>
       CheckShaderCacheFunc;
 
@@ -656,6 +675,8 @@ public:
   //           module cannot be compiled that way.  The client typically then does a whole-pipeline compilation
   //           instead. The client can call getLastError() to get a textual representation of the error, for
   //           use in logging or in error reporting in a command-line utility.
+  //           Also false if the cancel check set by setCancelCheck() returned true, in which case the output
+  //           must be discarded, and wasCancelled() returns true.
   virtual bool generate(std::unique_ptr<llvm::Module> pipelineModule, llvm::raw_pwrite_stream &outStream,
                         CheckShaderCacheFunc checkShaderCacheFunc, llvm::ArrayRef<llvm::Timer *> timers,
                         llvm::MemoryBufferRef otherElf) = 0;
@@ -672,6 +693,10 @@ public:
   //           one of the ElfLinker methods is called, or the Pipeline object is destroyed
   virtual llvm::StringRef getLastError() = 0;
 
+  // Get whether the last generate() was stopped by the cancel check set by setCancelCheck(), as opposed to failing
+  // for some other reason
+  virtual bool wasCancelled() const = 0;
+
   // -----------------------------------------------------------------------------------------------------------------
   // Non-compiling methods
 
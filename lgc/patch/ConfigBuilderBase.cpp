@@ -32,6 +32,7 @@
 #include "lgc/state/PalMetadata.h"
 #include "lgc/state/PipelineState.h"
 #include "lgc/state/TargetInfo.h"
+#include "lgc/state/WaveSizeHeuristic.h"
 #include "llvm/IR/Constants.h"
 
 #define DEBUG_TYPE "lgc-config-builder-base"
@@ -342,6 +343,21 @@ void ConfigBuilderBase::writePalMetadata() {
       oredValue = regEntry.getUInt();
     regEntry = oredValue;
   }
+
+  // Report the automatic wave size selection of each API shader, with the inputs it was based on.
+  for (unsigned stage = 0; stage < ShaderStageNativeStageCount; ++stage) {
+    const WaveSizeSelection &selection = m_pipelineState->getWaveSizeSelection(static_cast<ShaderStage>(stage));
+    if (selection.waveSize == 0)
+      continue;
+    auto selectionNode = getApiShaderNode(stage)[WaveSizeSelectionKey::WaveSizeSelection].getMap(true);
+    selectionNode[WaveSizeSelectionKey::WaveSize] = selection.waveSize;
+    selectionNode[WaveSizeSelectionKey::DefaultWaveSize] = selection.defaultWaveSize;
+    selectionNode[WaveSizeSelectionKey::VgprEstimate] = selection.vgprEstimate;
+    selectionNode[WaveSizeSelectionKey::LdsSize] = selection.ldsSize;
+    selectionNode[WaveSizeSelectionKey::DivergentPercent] = selection.divergentPercent;
+    selectionNode[WaveSizeSelectionKey::Score32] = selection.score32;
+    selectionNode[WaveSizeSelectionKey::Score64] = selection.score64;
+  }
 }
 
 // =====================================================================================================================
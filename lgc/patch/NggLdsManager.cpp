@@ -81,6 +81,30 @@ const unsigned NggLdsManager::LdsRegionSizes[LdsRegionCount] = {
     // clang-format on
 };
 
+// =====================================================================================================================
+// Initialize static members
+const NggLdsRegionLifetime NggLdsManager::LdsRegionLifetimes[LdsRegionCount] = {
+    // clang-format off
+    //
+    // LDS region lifetime for ES-only
+    //
+    { NggLdsPhaseDistribPrimId, NggLdsPhaseDistribPrimId }, // LdsRegionDistribPrimId
+    { NggLdsPhaseEs,            NggLdsPhaseExport },        // LdsRegionVertPosData
+    { NggLdsPhaseEs,            NggLdsPhaseExport },        // LdsRegionVertCullInfo
+    { NggLdsPhaseEs,            NggLdsPhaseCompaction },    // LdsRegionVertCountInWaves
+    { NggLdsPhaseCompaction,    NggLdsPhaseExport },        // LdsRegionVertThreadIdMap
+
+    //
+    // LDS region lifetime for ES-GS
+    //
+    { NggLdsPhaseEs,            NggLdsPhaseGs },            // LdsRegionEsGsRing
+    { NggLdsPhaseEs,            NggLdsPhaseExport },        // LdsRegionOutPrimData
+    { NggLdsPhaseEs,            NggLdsPhaseCompaction },    // LdsRegionOutVertCountInWaves
+    { NggLdsPhaseCompaction,    NggLdsPhaseExport },        // LdsRegionOutVertThreadIdMap
+    { NggLdsPhaseGs,            NggLdsPhaseExport },        // LdsRegionGsVsRing
+    // clang-format on
+};
+
 // =====================================================================================================================
 // Initialize static members
 const char *NggLdsManager::m_ldsRegionNames[LdsRegionCount] = {
@@ -135,44 +159,51 @@ NggLdsManager::NggLdsManager(Module *module, PipelineState *pipelineState, IRBui
 
   const auto &calcFactor = m_pipelineState->getShaderResourceUsage(ShaderStageGeometry)->inOutUsage.gs.calcFactor;
 
-  if (hasGs) {
+  if (hasGs || !nggControl->passthroughMode) {
+    //
+    // For ES-GS, the LDS layout is something like this (GS out vertex thread ID map is only live after the ES-GS ring
+    // is dead, so it overlaps the ES-GS ring when it fits):
+    //
+    // +------------+-----------------------+------------------------------+------------+
+    // | ES-GS ring | GS out primitive data | GS out vertex counts (waves) | GS-VS ring |
+    // +------------+-----------------------+------------------------------+------------+
+    // +-----------------------------+
+    // | GS out vertex thread ID map |
+    // +-----------------------------+
+    //
+    // For ES-only, the LDS layout is something like this:
     //
-    // The LDS layout is something like this:
+    // +--------------------------+
+    // | Distributed primitive ID |
+    // +--------------------------+
     //
-    // +------------+-----------------------+------------------------------+-----------------------------+------------+
-    // | ES-GS ring | GS out primitive data | GS out vertex counts (waves) | GS out vertex thread ID map | GS-VS ring |
-    // +------------+-----------------------+------------------------------+-----------------------------+------------+
+    // +----------------------+-------------------------------+-------------------------+----------------------+
+    // | Vertex position data | Vertex cull info (ES-GS ring) | Vertex count (in waves) | Vertex thread ID map |
+    // +----------------------+-------------------------------+-------------------------+----------------------+
     //
 
     // NOTE: We round ES-GS LDS size to 4-dword alignment. This is for later LDS read/write operations of mutilple
     // dwords (such as DS128).
-    const unsigned esGsRingLdsSize = alignTo(calcFactor.esGsLdsSize, 4u) * SizeOfDword;
-    const unsigned gsVsRingLdsSize =
-        calcFactor.gsOnChipLdsSize * SizeOfDword - esGsRingLdsSize - calcGsExtraLdsSize(m_pipelineState);
+    const unsigned esGsRingLdsSize = hasGs ? alignTo(calcFactor.esGsLdsSize, 4u) * SizeOfDword
+                                           : calcFactor.esGsRingItemSize * calcFactor.esVertsPerSubgroup * SizeOfDword;
 
-    unsigned ldsRegionStart = 0;
-
-    for (unsigned region = LdsRegionGsBeginRange; region <= LdsRegionGsEndRange; ++region) {
-      // NOTE: For vertex compactionless mode, this region is unnecessary
-      if (region == LdsRegionOutVertThreadIdMap && nggControl->compactMode == NggCompactDisable)
-        continue;
-
-      unsigned ldsRegionSize = LdsRegionSizes[region];
+    unsigned ldsRegionSizes[LdsRegionCount] = {};
+    const unsigned ldsLayoutEnd = layoutLdsRegions(m_pipelineState, esGsRingLdsSize, m_ldsRegionStart, ldsRegionSizes);
 
-      // NOTE: LDS size of ES-GS ring is calculated (by rounding it up to 16-byte alignment)
-      if (region == LdsRegionEsGsRing)
-        ldsRegionSize = esGsRingLdsSize;
-
-      // NOTE: LDS size of GS-VS ring is calculated
-      if (region == LdsRegionGsVsRing)
-        ldsRegionSize = gsVsRingLdsSize;
+    if (hasGs) {
+      // NOTE: GS-VS ring takes up the rest of LDS, after all other regions.
+      m_ldsRegionStart[LdsRegionGsVsRing] = ldsLayoutEnd;
+      ldsRegionSizes[LdsRegionGsVsRing] = calcFactor.gsOnChipLdsSize * SizeOfDword - ldsLayoutEnd;
+    }
 
-      m_ldsRegionStart[region] = ldsRegionStart;
-      assert(ldsRegionSize != InvalidValue);
-      ldsRegionStart += ldsRegionSize;
+    const unsigned beginRegion = hasGs ? LdsRegionGsBeginRange : LdsRegionEsBeginRange;
+    const unsigned endRegion = hasGs ? LdsRegionGsEndRange : LdsRegionEsEndRange;
+    for (unsigned region = beginRegion; region <= endRegion; ++region) {
+      if (m_ldsRegionStart[region] == InvalidValue)
+        continue;
 
       LLPC_OUTS(format("%-40s : offset = 0x%04" PRIX32 ", size = 0x%04" PRIX32, m_ldsRegionNames[region],
-                       m_ldsRegionStart[region], ldsRegionSize)
+                       m_ldsRegionStart[region], ldsRegionSizes[region])
                 << "\n");
     }
   } else {
@@ -181,45 +212,6 @@ NggLdsManager::NggLdsManager(Module *module, PipelineState *pipelineState, IRBui
     LLPC_OUTS(format("%-40s : offset = 0x%04" PRIX32 ", size = 0x%04" PRIX32, m_ldsRegionNames[LdsRegionDistribPrimId],
                      m_ldsRegionStart[LdsRegionDistribPrimId], LdsRegionSizes[LdsRegionDistribPrimId])
               << "\n");
-
-    if (!nggControl->passthroughMode) {
-      //
-      // The LDS layout is something like this:
-      //
-      // +--------------------------+
-      // | Distributed primitive ID |
-      // +--------------------------+
-      //
-      // +----------------------+-------------------------------+-------------------------+----------------------+
-      // | Vertex position data | Vertex cull info (ES-GS ring) | Vertex count (in waves) | Vertex thread ID map |
-      // +----------------------+-------------------------------+-------------------------+----------------------+
-      //
-      unsigned ldsRegionStart = 0;
-      for (unsigned region = LdsRegionEsBeginRange; region <= LdsRegionEsEndRange; ++region) {
-        // NOTE: For NGG culling mode, distributed primitive ID region is partially overlapped with vertex cull info
-        // region.
-        if (region == LdsRegionDistribPrimId)
-          continue;
-
-        // NOTE: For vertex compactionless mode, this region is unnecessary
-        if (region == LdsRegionVertThreadIdMap && nggControl->compactMode == NggCompactDisable)
-          continue;
-
-        unsigned ldsRegionSize = LdsRegionSizes[region];
-
-        // NOTE: LDS size of vertex cull info (ES-GS ring) is calculated
-        if (region == LdsRegionVertCullInfo)
-          ldsRegionSize = calcFactor.esGsRingItemSize * calcFactor.esVertsPerSubgroup * SizeOfDword;
-
-        m_ldsRegionStart[region] = ldsRegionStart;
-        assert(ldsRegionSize != InvalidValue);
-        ldsRegionStart += ldsRegionSize;
-
-        LLPC_OUTS(format("%-40s : offset = 0x%04" PRIX32 ", size = 0x%04" PRIX32, m_ldsRegionNames[region],
-                         m_ldsRegionStart[region], ldsRegionSize)
-                  << "\n");
-      }
-    }
   }
 
   LLPC_OUTS(format("%-40s :                  size = 0x%04" PRIX32, static_cast<const char *>("LDS total"),
@@ -228,10 +220,11 @@ NggLdsManager::NggLdsManager(Module *module, PipelineState *pipelineState, IRBui
 }
 
 // =====================================================================================================================
-// Calculates ES extra LDS size.
+// Calculates ES extra LDS size (used for operations other than vertex cull info read/write).
 //
 // @param pipelineState : Pipeline state
-unsigned NggLdsManager::calcEsExtraLdsSize(PipelineState *pipelineState) {
+// @param esGsRingLdsSize : LDS size of vertex cull info (ES-GS ring), in bytes
+unsigned NggLdsManager::calcEsExtraLdsSize(PipelineState *pipelineState, unsigned esGsRingLdsSize) {
   const auto nggControl = pipelineState->getNggControl();
   if (!nggControl->enableNgg)
     return 0;
@@ -255,15 +248,18 @@ unsigned NggLdsManager::calcEsExtraLdsSize(PipelineState *pipelineState) {
     return distributePrimitiveId ? LdsRegionSizes[LdsRegionDistribPrimId] : 0;
   }
 
-  return LdsRegionSizes[LdsRegionVertPosData] + LdsRegionSizes[LdsRegionVertCountInWaves] +
-         (nggControl->compactMode == NggCompactDisable ? 0 : LdsRegionSizes[LdsRegionVertThreadIdMap]);
+  unsigned ldsRegionStarts[LdsRegionCount] = {};
+  unsigned ldsRegionSizes[LdsRegionCount] = {};
+  return layoutLdsRegions(pipelineState, esGsRingLdsSize, ldsRegionStarts, ldsRegionSizes) - esGsRingLdsSize;
 }
 
 // =====================================================================================================================
-// Calculates GS extra LDS size (used for operations other than ES-GS ring and GS-VS ring read/write).
+// Calculates GS extra LDS size (used for operations other than ES-GS ring and GS-VS ring read/write). Regions that are
+// only live after the ES-GS ring is dead share its LDS space, so the result goes down as the ES-GS ring grows.
 //
 // @param pipelineState : Pipeline state
-unsigned NggLdsManager::calcGsExtraLdsSize(PipelineState *pipelineState) {
+// @param esGsRingLdsSize : LDS size of ES-GS ring, in bytes
+unsigned NggLdsManager::calcGsExtraLdsSize(PipelineState *pipelineState, unsigned esGsRingLdsSize) {
   const auto nggControl = pipelineState->getNggControl();
   if (!nggControl->enableNgg)
     return 0;
@@ -274,8 +270,85 @@ unsigned NggLdsManager::calcGsExtraLdsSize(PipelineState *pipelineState) {
     return 0;
   }
 
-  return LdsRegionSizes[LdsRegionOutPrimData] + LdsRegionSizes[LdsRegionOutVertCountInWaves] +
-         (nggControl->compactMode == NggCompactDisable ? 0 : LdsRegionSizes[LdsRegionOutVertThreadIdMap]);
+  unsigned ldsRegionStarts[LdsRegionCount] = {};
+  unsigned ldsRegionSizes[LdsRegionCount] = {};
+  return layoutLdsRegions(pipelineState, esGsRingLdsSize, ldsRegionStarts, ldsRegionSizes) - esGsRingLdsSize;
+}
+
+// =====================================================================================================================
+// Lays out LDS regions used by NGG primitive shader other than GS-VS ring, which takes up the rest of LDS. Each region
+// is placed at the lowest offset where it doesn't overlap a region placed before it that is live at the same time, so
+// regions whose lifetimes don't intersect share LDS space. Returns the end of the layout (in bytes).
+//
+// @param pipelineState : Pipeline state
+// @param esGsRingLdsSize : LDS size of ES-GS ring (or vertex cull info for ES-only), in bytes
+// @param [out] regionStarts : Start LDS offsets of all LDS region types (InvalidValue for unused ones), in bytes
+// @param [out] regionSizes : LDS sizes of all LDS region types (0 for unused ones), in bytes
+unsigned NggLdsManager::layoutLdsRegions(PipelineState *pipelineState, unsigned esGsRingLdsSize,
+                                         unsigned regionStarts[LdsRegionCount], unsigned regionSizes[LdsRegionCount]) {
+  const auto nggControl = pipelineState->getNggControl();
+  const bool hasGs = pipelineState->hasShaderStage(ShaderStageGeometry);
+  assert(hasGs || !nggControl->passthroughMode);
+
+  for (unsigned region = 0; region < LdsRegionCount; ++region) {
+    regionStarts[region] = InvalidValue;
+    regionSizes[region] = 0;
+  }
+
+  const unsigned beginRegion = hasGs ? LdsRegionGsBeginRange : LdsRegionEsBeginRange;
+  const unsigned endRegion = hasGs ? LdsRegionGsEndRange : LdsRegionEsEndRange;
+
+  unsigned ldsLayoutEnd = 0;
+  for (unsigned region = beginRegion; region <= endRegion; ++region) {
+    // NOTE: For vertex compactionless mode, these regions are unnecessary
+    if ((region == LdsRegionVertThreadIdMap || region == LdsRegionOutVertThreadIdMap) &&
+        nggControl->compactMode == NggCompactDisable)
+      continue;
+
+    // NOTE: GS-VS ring takes up the rest of LDS, so it is placed after all other regions by the caller.
+    if (region == LdsRegionGsVsRing)
+      continue;
+
+    unsigned ldsRegionSize = LdsRegionSizes[region];
+
+    // NOTE: LDS size of ES-GS ring (or vertex cull info) is calculated
+    if (region == LdsRegionEsGsRing || region == LdsRegionVertCullInfo)
+      ldsRegionSize = esGsRingLdsSize;
+
+    assert(ldsRegionSize != InvalidValue);
+
+    // Move the region past every placed region it overlaps while both are live, until there is none. Every offset
+    // skipped over overlaps that placed region, so this ends up at the lowest possible offset.
+    const auto &lifetime = LdsRegionLifetimes[region];
+    unsigned ldsRegionStart = 0;
+    bool overlapped = true;
+    while (overlapped) {
+      overlapped = false;
+      for (unsigned placedRegion = beginRegion; placedRegion < region; ++placedRegion) {
+        if (regionStarts[placedRegion] == InvalidValue)
+          continue;
+
+        const auto &placedLifetime = LdsRegionLifetimes[placedRegion];
+        if (lifetime.lastPhase < placedLifetime.firstPhase || placedLifetime.lastPhase < lifetime.firstPhase)
+          continue; // Never live at the same time
+
+        const unsigned placedRegionEnd = regionStarts[placedRegion] + regionSizes[placedRegion];
+        if (ldsRegionStart < placedRegionEnd && regionStarts[placedRegion] < ldsRegionStart + ldsRegionSize) {
+          ldsRegionStart = placedRegionEnd;
+          overlapped = true;
+        }
+      }
+    }
+
+    regionStarts[region] = ldsRegionStart;
+    regionSizes[region] = ldsRegionSize;
+    ldsLayoutEnd = std::max(ldsLayoutEnd, ldsRegionStart + ldsRegionSize);
+  }
+
+  // NOTE: ES-GS ring (or vertex position data for ES-only) is expected to be at the beginning of LDS.
+  assert(regionStarts[hasGs ? LdsRegionEsGsRing : LdsRegionVertPosData] == 0);
+
+  return ldsLayoutEnd;
 }
 
 // =====================================================================================================================
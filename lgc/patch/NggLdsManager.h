@@ -71,6 +71,23 @@ enum NggLdsRegionType {
   // clang-format on
 };
 
+// Enumerates the phases of NGG primitive shader (in program order) that LDS regions live through. Adjacent phases
+// are separated by barriers, so LDS regions whose lifetimes don't intersect are allowed to share LDS space.
+enum NggLdsPhase : unsigned {
+  NggLdsPhaseDistribPrimId, // Distribution of primitive ID (ES only, before ES is run)
+  NggLdsPhaseEs,            // ES run, together with the LDS initialization done alongside it
+  NggLdsPhaseGs,            // GS run
+  NggLdsPhaseCulling,       // Primitive culling
+  NggLdsPhaseCompaction,    // Vertex compaction
+  NggLdsPhaseExport,        // Primitive and vertex export
+};
+
+// Represents the lifetime of an LDS region, from the phase it is first written in to the phase it is last read in.
+struct NggLdsRegionLifetime {
+  NggLdsPhase firstPhase; // First phase in which the region is live
+  NggLdsPhase lastPhase;  // Last phase in which the region is live
+};
+
 // Size of a dword
 static const unsigned SizeOfDword = sizeof(unsigned);
 
@@ -80,8 +97,8 @@ class NggLdsManager {
 public:
   NggLdsManager(llvm::Module *module, PipelineState *pipelineState, llvm::IRBuilder<> *builder);
 
-  static unsigned calcEsExtraLdsSize(PipelineState *pipelineState);
-  static unsigned calcGsExtraLdsSize(PipelineState *pipelineState);
+  static unsigned calcEsExtraLdsSize(PipelineState *pipelineState, unsigned esGsRingLdsSize);
+  static unsigned calcGsExtraLdsSize(PipelineState *pipelineState, unsigned esGsRingLdsSize);
 
   // Gets the LDS starting offset for the specified region
   unsigned getLdsRegionStart(NggLdsRegionType region) const {
@@ -100,8 +117,12 @@ private:
   NggLdsManager(const NggLdsManager &) = delete;
   NggLdsManager &operator=(const NggLdsManager &) = delete;
 
-  static const unsigned LdsRegionSizes[LdsRegionCount]; // LDS sizes for all LDS region types (in bytes)
-  static const char *m_ldsRegionNames[LdsRegionCount];  // Name strings for all LDS region types
+  static unsigned layoutLdsRegions(PipelineState *pipelineState, unsigned esGsRingLdsSize,
+                                   unsigned regionStarts[LdsRegionCount], unsigned regionSizes[LdsRegionCount]);
+
+  static const unsigned LdsRegionSizes[LdsRegionCount];                 // LDS sizes for all LDS region types (in bytes)
+  static const NggLdsRegionLifetime LdsRegionLifetimes[LdsRegionCount]; // Lifetimes of all LDS region types
+  static const char *m_ldsRegionNames[LdsRegionCount];                  // Name strings for all LDS region types
 
   PipelineState *m_pipelineState; // Pipeline state
   llvm::LLVMContext *m_context;   // LLVM context
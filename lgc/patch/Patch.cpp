@@ -73,6 +73,12 @@ opt<CodeGenOpt::Level> OptLevel("opt", desc("Set the optimization level:"), init
                                        clEnumValN(CodeGenOpt::Default, "default", "default optimizations"),
                                        clEnumValN(CodeGenOpt::Aggressive, "fast", "fast execution time")));
 
+// -hoist-descriptor-loads: hoist descriptor loads made on every path to the start of the shader and share duplicates
+opt<bool> HoistDescriptorLoads("hoist-descriptor-loads",
+                               desc("Hoist descriptor loads made on every path to the start of the shader, and "
+                                    "share duplicate descriptor loads"),
+                               init(false));
+
 } // namespace cl
 
 } // namespace llvm
@@ -137,6 +143,10 @@ void Patch::addPasses(PipelineState *pipelineState, legacy::PassManager &passMgr
   passMgr.add(createAlwaysInlinerLegacyPass());
   passMgr.add(createGlobalDCEPass());
 
+  // Hoist descriptor table pointers and descriptor loads to the start of the shader and remove duplicates
+  if (cl::HoistDescriptorLoads)
+    passMgr.add(createPatchDescriptorLoadOpt());
+
   // Patch loop metadata
   passMgr.add(createPatchLoopMetadata());
 
@@ -159,8 +169,15 @@ void Patch::addPasses(PipelineState *pipelineState, legacy::PassManager &passMgr
   // Need to run a first promote mem 2 reg to remove alloca's whose only args are lifetimes
   passMgr.add(createPromoteMemoryToRegisterPass());
 
-  if (!cl::DisablePatchOpt)
-    addOptimizationPasses(passMgr);
+  if (!cl::DisablePatchOpt) {
+    if (pipelineState->getOptions().fastCompile)
+      addFastCompileOptimizationPasses(passMgr);
+    else
+      addOptimizationPasses(passMgr);
+
+    // Merge waterfall loops over the same non-uniform index (after optimizations have unified the index values)
+    passMgr.add(createPatchWaterfallFusion());
+  }
 
   // Stop timer for optimization passes and restart timer for patching passes.
   if (patchTimer) {
@@ -221,6 +238,20 @@ void Patch::addPasses(PipelineState *pipelineState, legacy::PassManager &passMgr
   }
 }
 
+// =====================================================================================================================
+// Add the minimal set of optimization passes used for a fast compile. These are cheap cleanups of what the patching
+// passes leave behind, so the backend does not have to chew through obviously dead or redundant code.
+//
+// @param [in/out] passMgr : Pass manager to add passes to
+void Patch::addFastCompileOptimizationPasses(legacy::PassManager &passMgr) {
+  LLPC_OUTS("PassManager optimization level = fast compile\n");
+
+  passMgr.add(createInstSimplifyLegacyPass());
+  passMgr.add(createEarlyCSEPass());
+  passMgr.add(createCFGSimplificationPass());
+  passMgr.add(createAggressiveDCEPass());
+}
+
 // =====================================================================================================================
 // Add optimization passes to pass manager
 //
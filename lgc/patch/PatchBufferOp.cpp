@@ -34,12 +34,15 @@
 #include "lgc/state/IntrinsDefs.h"
 #include "lgc/state/PipelineState.h"
 #include "lgc/state/TargetInfo.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/Analysis/LegacyDivergenceAnalysis.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/IntrinsicsAMDGPU.h"
+#include "llvm/IR/PatternMatch.h"
 #include "llvm/InitializePasses.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
@@ -47,8 +50,14 @@
 #define DEBUG_TYPE "lgc-patch-buffer-op"
 
 using namespace llvm;
+using namespace llvm::PatternMatch;
 using namespace lgc;
 
+// -merge-scalar-buffer-loads: merge neighbouring uniform buffer loads into wide s_buffer_load instructions
+static cl::opt<bool> MergeScalarBufferLoads("merge-scalar-buffer-loads",
+                                            cl::desc("Merge neighbouring uniform buffer loads into wide s_buffer_load"),
+                                            cl::init(false));
+
 namespace lgc {
 
 // =====================================================================================================================
@@ -127,6 +136,10 @@ bool PatchBufferOp::runOnFunction(Function &function) {
     inst->eraseFromParent();
   }
 
+  if (MergeScalarBufferLoads)
+    mergeScalarBufferLoads();
+  m_scalarLoads.clear();
+
   m_replacementMap.clear();
   m_incompletePhis.clear();
   m_invariantSet.clear();
@@ -1486,8 +1499,12 @@ Value *PatchBufferOp::replaceLoadStore(Instruction &inst) {
         coherent.bits.dlc = isDlc;
       }
       if (isInvariant && accessSize >= 4) {
-        part = m_builder->CreateIntrinsic(Intrinsic::amdgcn_s_buffer_load, intAccessType,
-                                          {bufferDesc, offsetVal, m_builder->getInt32(coherent.u32All)});
+        CallInst *const scalarLoad =
+            m_builder->CreateIntrinsic(Intrinsic::amdgcn_s_buffer_load, intAccessType,
+                                       {bufferDesc, offsetVal, m_builder->getInt32(coherent.u32All)});
+        // Remember it so that mergeScalarBufferLoads can combine it with its neighbours.
+        m_scalarLoads.push_back(scalarLoad);
+        part = scalarLoad;
       } else {
         unsigned intrinsicID = Intrinsic::amdgcn_raw_buffer_load;
 #if !defined(LLVM_HAVE_BRANCH_AMD_GFX)
@@ -1691,6 +1708,120 @@ void PatchBufferOp::fixIncompletePhis() {
   }
 }
 
+// =====================================================================================================================
+// Merge the s_buffer_load calls created by this pass that read neighbouring dwords of the same buffer.
+//
+// replaceLoadStore lowers each uniform load on its own, so neighbouring members of a uniform block end up as
+// separate s_buffer_load_dword/dwordx2/dwordx4 instructions. Here the loads in each basic block are grouped by buffer
+// descriptor, non-constant part of the offset and cache policy, and each contiguous run of dwords whose length is a
+// power of two (up to MaxScalarLoadDwords) is read by a single wide load instead. Gaps between loads are never filled
+// in: every dword of a merged load was read by one of the original loads, so with robust buffer access the merge
+// neither reads memory nor crosses a bound that the original loads did not.
+void PatchBufferOp::mergeScalarBufferLoads() {
+  struct ScalarLoad {
+    CallInst *call;      // The s_buffer_load call
+    unsigned beginDword; // First dword read, relative to the non-constant part of the offset
+    unsigned endDword;   // One past the last dword read
+  };
+  // Key is {{block, buffer descriptor}, {non-constant offset (or null), cache policy}}.
+  using GroupKey = std::pair<std::pair<BasicBlock *, Value *>, std::pair<Value *, Value *>>;
+  MapVector<GroupKey, SmallVector<ScalarLoad, 8>> groups;
+
+  for (CallInst *const call : m_scalarLoads) {
+    // Split the offset into a non-constant base and a constant byte offset.
+    Value *const offset = call->getArgOperand(1);
+    Value *base = nullptr;
+    ConstantInt *constOffset = dyn_cast<ConstantInt>(offset);
+    if (!constOffset && !match(offset, m_Add(m_Value(base), m_ConstantInt(constOffset)))) {
+      base = offset;
+      constOffset = m_builder->getInt32(0);
+    }
+    if ((constOffset->getZExtValue() & 0x3) != 0)
+      continue;
+
+    unsigned dwordCount = 1;
+    if (auto vectorTy = dyn_cast<FixedVectorType>(call->getType()))
+      dwordCount = vectorTy->getNumElements();
+    const unsigned beginDword = constOffset->getZExtValue() / 4;
+
+    GroupKey key = {{call->getParent(), call->getArgOperand(0)}, {base, call->getArgOperand(2)}};
+    groups[key].push_back({call, beginDword, beginDword + dwordCount});
+  }
+
+  for (auto &group : groups) {
+    SmallVectorImpl<ScalarLoad> &loads = group.second;
+    if (loads.size() < 2)
+      continue;
+
+    llvm::sort(loads, [](const ScalarLoad &lhs, const ScalarLoad &rhs) {
+      return std::make_pair(lhs.beginDword, lhs.endDword) < std::make_pair(rhs.beginDword, rhs.endDword);
+    });
+
+    for (unsigned firstIdx = 0; firstIdx < loads.size();) {
+      // Find the longest run of loads, starting at firstIdx, that covers a contiguous power-of-two number of dwords.
+      const unsigned beginDword = loads[firstIdx].beginDword;
+      unsigned endDword = loads[firstIdx].endDword;
+      unsigned runEndIdx = firstIdx + 1;
+      unsigned runEndDword = endDword;
+      for (unsigned idx = firstIdx + 1; idx < loads.size() && loads[idx].beginDword <= endDword; ++idx) {
+        endDword = std::max(endDword, loads[idx].endDword);
+        if (endDword - beginDword > MaxScalarLoadDwords)
+          break;
+        if (isPowerOf2_32(endDword - beginDword)) {
+          runEndIdx = idx + 1;
+          runEndDword = endDword;
+        }
+      }
+
+      if (runEndIdx - firstIdx >= 2) {
+        ArrayRef<ScalarLoad> run = makeArrayRef(loads).slice(firstIdx, runEndIdx - firstIdx);
+        const unsigned dwordCount = runEndDword - beginDword;
+
+        // The wide load goes where the first of the loads it replaces was.
+        CallInst *firstLoad = run.front().call;
+        for (const ScalarLoad &load : run) {
+          if (load.call->comesBefore(firstLoad))
+            firstLoad = load.call;
+        }
+        m_builder->SetInsertPoint(firstLoad);
+
+        Value *const base = group.first.second.first;
+        Value *offset = m_builder->getInt32(beginDword * 4);
+        if (base)
+          offset = beginDword == 0 ? base : m_builder->CreateAdd(base, offset);
+
+        Type *wideTy = m_builder->getInt32Ty();
+        if (dwordCount > 1)
+          wideTy = FixedVectorType::get(wideTy, dwordCount);
+        CallInst *const wideLoad = m_builder->CreateIntrinsic(
+            Intrinsic::amdgcn_s_buffer_load, wideTy, {group.first.first.second, offset, group.first.second.second});
+        copyMetadata(wideLoad, firstLoad);
+
+        // Replace each original load with the dwords it read from the wide load.
+        for (const ScalarLoad &load : run) {
+          m_builder->SetInsertPoint(load.call);
+          const unsigned firstElem = load.beginDword - beginDword;
+          const unsigned elemCount = load.endDword - load.beginDword;
+          Value *part = wideLoad;
+          if (elemCount == 1 && dwordCount > 1) {
+            part = m_builder->CreateExtractElement(wideLoad, firstElem);
+          } else if (elemCount != dwordCount) {
+            SmallVector<int, 4> mask;
+            for (unsigned elemIdx = 0; elemIdx != elemCount; ++elemIdx)
+              mask.push_back(firstElem + elemIdx);
+            part = m_builder->CreateShuffleVector(wideLoad, wideLoad, mask);
+          }
+          copyMetadata(part, load.call);
+          load.call->replaceAllUsesWith(part);
+          load.call->eraseFromParent();
+        }
+      }
+
+      firstIdx = runEndIdx;
+    }
+  }
+}
+
 } // namespace lgc
 
 // =====================================================================================================================
@@ -88,6 +88,7 @@ private:
   void postVisitMemCpyInst(llvm::MemCpyInst &memCpyInst);
   void postVisitMemSetInst(llvm::MemSetInst &memSetInst);
   void fixIncompletePhis();
+  void mergeScalarBufferLoads();
 
   using Replacement = std::pair<llvm::Value *, llvm::Value *>;
   using PhiIncoming = std::pair<llvm::PHINode *, llvm::BasicBlock *>;
@@ -97,11 +98,13 @@ private:
   llvm::DenseSet<llvm::Value *> m_divergenceSet;               // The divergence set.
   llvm::LegacyDivergenceAnalysis *m_divergenceAnalysis;        // The divergence analysis.
   llvm::SmallVector<llvm::Instruction *, 16> m_postVisitInsts; // The post process instruction set.
+  llvm::SmallVector<llvm::CallInst *, 16> m_scalarLoads;       // The s_buffer_load calls created by this pass.
   std::unique_ptr<llvm::IRBuilder<>> m_builder;                // The IRBuilder.
   llvm::LLVMContext *m_context;                                // The LLVM context.
   PipelineState *m_pipelineState;                              // The pipeline state
 
   static constexpr unsigned MinMemOpLoopBytes = 256;
+  static constexpr unsigned MaxScalarLoadDwords = 16; // Widest s_buffer_load (s_buffer_load_dwordx16)
 };
 
 } // namespace lgc
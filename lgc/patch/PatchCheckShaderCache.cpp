@@ -30,7 +30,9 @@
  */
 #include "PatchCheckShaderCache.h"
 #include "lgc/state/PipelineShaders.h"
+#include "lgc/util/Debug.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Format.h"
 
 #define DEBUG_TYPE "lgc-patch-check-shader-cache"
 
@@ -51,25 +53,6 @@ PatchCheckShaderCache *createPatchCheckShaderCache() {
 
 } // namespace lgc
 
-namespace {
-
-// =====================================================================================================================
-// Stream each map key and value for later inclusion in a hash
-template <class MapType>
-//
-// @param map : Map to stream
-// @param [in/out] stream : Stream to output map entries to
-static void streamMapEntries(MapType &map, raw_ostream &stream) {
-  size_t mapCount = map.size();
-  stream << StringRef(reinterpret_cast<const char *>(&mapCount), sizeof(mapCount));
-  for (auto mapIt : map) {
-    stream << StringRef(reinterpret_cast<const char *>(&mapIt.first), sizeof(mapIt.first));
-    stream << StringRef(reinterpret_cast<const char *>(&mapIt.second), sizeof(mapIt.second));
-  }
-}
-
-} // namespace
-
 // =====================================================================================================================
 PatchCheckShaderCache::PatchCheckShaderCache() : Patch(ID) {
 }
@@ -88,6 +71,29 @@ bool PatchCheckShaderCache::runOnModule(Module &module) {
 
   Patch::init(&module);
 
+  uint64_t stageHashes[ShaderStageGfxCount][2] = {};
+  ArrayRef<uint8_t> stageHashValues[ShaderStageGfxCount];
+  PipelineState *pipelineState = getAnalysis<PipelineStateWrapper>().getPipelineState(&module);
+  PipelineShaders *pipelineShaders = &getAnalysis<PipelineShaders>();
+  auto stageMask = pipelineState->getShaderStageMask();
+
+  // Get the inter-shader data hash per shader stage. Each pass that made a decision based on data from another shader
+  // stage has already folded that data into the hash attached to the shader's entry-point.
+  for (auto stage = ShaderStageVertex; stage < ShaderStageGfxCount; stage = static_cast<ShaderStage>(stage + 1)) {
+    if ((stageMask & shaderStageToMask(stage)) == 0)
+      continue;
+
+    Function *entryPoint = pipelineShaders->getEntryPoint(stage);
+    if (entryPoint && getShaderHash(entryPoint, stageHashes[stage])) {
+      stageHashValues[stage] =
+          ArrayRef<uint8_t>(reinterpret_cast<const uint8_t *>(stageHashes[stage]), sizeof(stageHashes[stage]));
+    }
+  }
+
+  // The hashes are not needed past this point.
+  for (Function &func : module)
+    clearShaderHash(&func);
+
   // NOTE: Global constants are either added to the end of the .text section, or in a separate .rodata section with
   // relocs in the .text section to refer to them. We can't merge ELF binaries if relocs are used because llpcElfWriter
   // doesn't know how to merge them.
@@ -109,43 +115,18 @@ bool PatchCheckShaderCache::runOnModule(Module &module) {
     }
   }
 
-  std::string inOutUsageStreams[ShaderStageGfxCount];
-  ArrayRef<uint8_t> inOutUsageValues[ShaderStageGfxCount];
-  PipelineState *pipelineState = getAnalysis<PipelineStateWrapper>().getPipelineState(&module);
-  auto stageMask = pipelineState->getShaderStageMask();
-
-  // Build input/output layout hash per shader stage
+  LLPC_OUTS("===============================================================================\n");
+  LLPC_OUTS("// LLPC inter-shader data hash results\n\n");
   for (auto stage = ShaderStageVertex; stage < ShaderStageGfxCount; stage = static_cast<ShaderStage>(stage + 1)) {
-    if ((stageMask & shaderStageToMask(stage)) == 0)
-      continue;
-
-    auto resUsage = pipelineState->getShaderResourceUsage(stage);
-    raw_string_ostream stream(inOutUsageStreams[stage]);
-
-    // Update input/output usage
-    streamMapEntries(resUsage->inOutUsage.inputLocInfoMap, stream);
-    streamMapEntries(resUsage->inOutUsage.outputLocInfoMap, stream);
-    streamMapEntries(resUsage->inOutUsage.perPatchInputLocMap, stream);
-    streamMapEntries(resUsage->inOutUsage.perPatchOutputLocMap, stream);
-    streamMapEntries(resUsage->inOutUsage.builtInInputLocMap, stream);
-    streamMapEntries(resUsage->inOutUsage.builtInOutputLocMap, stream);
-    streamMapEntries(resUsage->inOutUsage.perPatchBuiltInInputLocMap, stream);
-    streamMapEntries(resUsage->inOutUsage.perPatchBuiltInOutputLocMap, stream);
-
-    if (stage == ShaderStageGeometry) {
-      // NOTE: For geometry shader, copy shader will use this special map info (from built-in outputs to
-      // locations of generic outputs). We have to add it to shader hash calculation.
-      streamMapEntries(resUsage->inOutUsage.gs.builtInOutLocs, stream);
+    if (!stageHashValues[stage].empty()) {
+      LLPC_OUTS(format("%-4s : ", getShaderStageAbbreviation(stage))
+                << format_hex(stageHashes[stage][1], 18) << format_hex_no_prefix(stageHashes[stage][0], 16) << "\n");
     }
-
-    // Store the result of the hash for this shader stage.
-    stream.flush();
-    inOutUsageValues[stage] = ArrayRef<uint8_t>(reinterpret_cast<const uint8_t *>(inOutUsageStreams[stage].data()),
-                                                inOutUsageStreams[stage].size());
   }
+  LLPC_OUTS("\n");
 
   // Ask callback function if it wants to remove any shader stages.
-  unsigned modifiedStageMask = m_callbackFunc(&module, stageMask, inOutUsageValues);
+  unsigned modifiedStageMask = m_callbackFunc(&module, stageMask, stageHashValues);
   if (modifiedStageMask == stageMask)
     return false;
 
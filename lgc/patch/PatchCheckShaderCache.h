@@ -50,9 +50,9 @@ public:
   virtual bool runOnModule(llvm::Module &module) override;
 
   // Set the callback function that this pass uses to ask the front-end whether it wants to remove
-  // any shader stages. The function takes the LLVM IR module and a per-shader-stage array of input/output
-  // usage checksums, and it returns the shader stage mask with bits removed for shader stages that it wants
-  // removed.
+  // any shader stages. The function takes the LLVM IR module and a per-shader-stage array of hashes of the
+  // inter-shader data used to compile each stage, and it returns the shader stage mask with bits removed for shader
+  // stages that it wants removed.
   void setCallbackFunction(Pipeline::CheckShaderCacheFunc callbackFunc) { m_callbackFunc = callbackFunc; }
 
   static char ID; // ID of this pass
@@ -0,0 +1,297 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2017-2020 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  PatchDescriptorLoadOpt.cpp
+ * @brief LLPC source file: contains implementation of class lgc::PatchDescriptorLoadOpt.
+ ***********************************************************************************************************************
+ */
+#include "PatchDescriptorLoadOpt.h"
+#include "lgc/state/IntrinsDefs.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/IntrinsicsAMDGPU.h"
+#include "llvm/InitializePasses.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+#define DEBUG_TYPE "lgc-patch-descriptor-load-opt"
+
+using namespace lgc;
+using namespace llvm;
+
+namespace lgc {
+
+// =====================================================================================================================
+// Define static members (no initializer needed as LLVM only cares about the address of ID, never its value).
+char PatchDescriptorLoadOpt::ID;
+
+// =====================================================================================================================
+// Pass creator, creates the pass of LLVM patching operations for descriptor load optimizations.
+FunctionPass *createPatchDescriptorLoadOpt() {
+  return new PatchDescriptorLoadOpt();
+}
+
+// =====================================================================================================================
+PatchDescriptorLoadOpt::PatchDescriptorLoadOpt() : FunctionPass(ID) {
+}
+
+// =====================================================================================================================
+// Executes this LLVM pass on the specified LLVM function.
+//
+// @param [in/out] function : Function that will run this optimization.
+bool PatchDescriptorLoadOpt::runOnFunction(Function &function) {
+  LLVM_DEBUG(dbgs() << "Run the pass Patch-Descriptor-Load-Opt\n");
+
+  if (skipFunction(function))
+    return false;
+
+  PostDominatorTree &postDomTree = getAnalysis<PostDominatorTreeWrapperPass>().getPostDomTree();
+  m_function = &function;
+  m_lastHoisted = nullptr;
+  m_hoistedSet.clear();
+  m_hoistedMap.clear();
+  m_deadInsts.clear();
+
+  // Visit blocks in reverse post-order, so that (loops aside) an instruction's operands are visited before it.
+  SmallVector<Instruction *, 64> insts;
+  for (BasicBlock *block : ReversePostOrderTraversal<Function *>(&function)) {
+    for (Instruction &inst : *block)
+      insts.push_back(&inst);
+  }
+
+  // First hoist the descriptor and pointer loads that are executed on every path through the function, that is, those
+  // in a block that post-dominates the entry block, along with their address computations. That does not add a load
+  // to any path. Loads that are only executed conditionally stay where they are, so that they do not add SGPR pressure
+  // and speculative loads to the paths that do not need them.
+  bool changed = false;
+  BasicBlock *entryBlock = &function.front();
+  for (Instruction *inst : insts) {
+    if (!isDescriptorLoad(inst) || m_hoistedSet.count(inst) != 0 || m_deadInsts.count(inst) != 0 ||
+        !postDomTree.dominates(inst->getParent(), entryBlock))
+      continue;
+    if (!canHoist(cast<LoadInst>(inst)->getPointerOperand(), 0))
+      continue;
+    hoist(inst);
+    changed = true;
+  }
+
+  // Then replace the same loads and address computations elsewhere in the function with the hoisted ones. In
+  // reverse post-order, the operands of an instruction have been replaced by the time it is visited, so a whole
+  // address computation is matched.
+  if (!m_hoistedSet.empty()) {
+    for (Instruction *inst : insts) {
+      if (m_hoistedSet.count(inst) != 0 || m_deadInsts.count(inst) != 0 ||
+          (!isConstantLoad(inst) && !isAddressComputation(inst)))
+        continue;
+      if (!all_of(inst->operands(), [this](Value *operand) { return isInvariant(operand); }))
+        continue;
+      if (Instruction *hoisted = findHoisted(inst))
+        replace(inst, hoisted);
+    }
+  }
+
+  changed |= !m_deadInsts.empty();
+  for (Instruction *inst : m_deadInsts)
+    inst->eraseFromParent();
+  m_deadInsts.clear();
+  return changed;
+}
+
+// =====================================================================================================================
+// Gets the hash of an instruction, from what it computes. Instructions that are identical have the same hash.
+//
+// @param inst : Instruction to hash
+unsigned PatchDescriptorLoadOpt::IdenticalInstInfo::getHashValue(const Instruction *inst) {
+  return hash_combine(inst->getOpcode(), inst->getType(),
+                      hash_combine_range(inst->value_op_begin(), inst->value_op_end()));
+}
+
+// =====================================================================================================================
+// Checks whether two instructions compute the same value.
+//
+// @param lhs : First instruction, or the empty or tombstone key
+// @param rhs : Second instruction, or the empty or tombstone key
+bool PatchDescriptorLoadOpt::IdenticalInstInfo::isEqual(const Instruction *lhs, const Instruction *rhs) {
+  if (lhs == rhs)
+    return true;
+  if (lhs == getEmptyKey() || lhs == getTombstoneKey() || rhs == getEmptyKey() || rhs == getTombstoneKey())
+    return false;
+  return lhs->isIdenticalTo(rhs);
+}
+
+// =====================================================================================================================
+// Checks whether a value is the same throughout the function and available at its start: a constant, a user data SGPR
+// argument, or an instruction already hoisted.
+//
+// @param value : Value to check
+bool PatchDescriptorLoadOpt::isInvariant(Value *value) const {
+  if (isa<Constant>(value))
+    return true;
+  if (auto arg = dyn_cast<Argument>(value))
+    return arg->hasInRegAttr();
+  if (auto inst = dyn_cast<Instruction>(value))
+    return m_hoistedSet.count(inst) != 0;
+  return false;
+}
+
+// =====================================================================================================================
+// Checks whether an instruction is a simple load from constant memory. Constant memory is never written by the shader.
+//
+// @param inst : Instruction to check
+bool PatchDescriptorLoadOpt::isConstantLoad(Instruction *inst) const {
+  auto load = dyn_cast<LoadInst>(inst);
+  if (!load || !load->isSimple())
+    return false;
+  unsigned addrSpace = load->getPointerAddressSpace();
+  return addrSpace == ADDR_SPACE_CONST || addrSpace == ADDR_SPACE_CONST_32BIT;
+}
+
+// =====================================================================================================================
+// Checks whether an instruction loads a descriptor, or a pointer to constant memory such as a descriptor table, from
+// constant memory. A descriptor is <4 x i32> (buffer, texel buffer or sampler) or <8 x i32> (image or fmask). Other
+// constant memory loads (such as of push constants) are not hoisted on their own.
+//
+// NOTE: By the time this pass runs, a descriptor load is a plain load, so a push constant that is itself a <4 x i32>
+// or <8 x i32> looks the same and is hoisted too. That is still safe, as it is a load from constant memory executed on
+// every path.
+//
+// @param inst : Instruction to check
+bool PatchDescriptorLoadOpt::isDescriptorLoad(Instruction *inst) const {
+  if (!isConstantLoad(inst))
+    return false;
+  Type *loadTy = inst->getType();
+  if (auto ptrTy = dyn_cast<PointerType>(loadTy))
+    return ptrTy->getAddressSpace() == ADDR_SPACE_CONST || ptrTy->getAddressSpace() == ADDR_SPACE_CONST_32BIT;
+  auto vecTy = dyn_cast<FixedVectorType>(loadTy);
+  return vecTy && vecTy->getElementType()->isIntegerTy(32) &&
+         (vecTy->getNumElements() == 4 || vecTy->getNumElements() == 8);
+}
+
+// =====================================================================================================================
+// Checks whether an instruction is one that can be part of the computation of a descriptor address: a relocation
+// constant, the PC (whose high half is used to extend 32-bit addresses), or side-effect-free arithmetic.
+//
+// @param inst : Instruction to check
+bool PatchDescriptorLoadOpt::isAddressComputation(Instruction *inst) const {
+  if (auto intrinsic = dyn_cast<IntrinsicInst>(inst)) {
+    return intrinsic->getIntrinsicID() == Intrinsic::amdgcn_reloc_constant ||
+           intrinsic->getIntrinsicID() == Intrinsic::amdgcn_s_getpc;
+  }
+  if (isa<PHINode>(inst) || inst->isTerminator() || isa<CallBase>(inst) || inst->mayReadOrWriteMemory())
+    return false;
+  return isSafeToSpeculativelyExecute(inst);
+}
+
+// =====================================================================================================================
+// Checks whether a value used in the address of a hoisted load can be hoisted to the start of the function: it is
+// invariant, or it is an address computation or constant memory load whose operands can be hoisted.
+//
+// A load here is always executed when the load whose address it computes is, as its block dominates that load's
+// block.
+//
+// @param value : Value to check
+// @param depth : Depth of the value in the address computation
+bool PatchDescriptorLoadOpt::canHoist(Value *value, unsigned depth) const {
+  static const unsigned MaxDepth = 16;
+  if (isInvariant(value))
+    return true;
+  auto inst = dyn_cast<Instruction>(value);
+  if (!inst || depth == MaxDepth || (!isConstantLoad(inst) && !isAddressComputation(inst)))
+    return false;
+  for (Value *operand : inst->operands()) {
+    if (!canHoist(operand, depth + 1))
+      return false;
+  }
+  return true;
+}
+
+// =====================================================================================================================
+// Moves a value that passed canHoist() to the start of the function, after those already hoisted, hoisting its
+// operands first. If the same value has already been hoisted, the value is replaced by that instead.
+//
+// @param value : Value to hoist
+// @returns : The hoisted value
+Value *PatchDescriptorLoadOpt::hoist(Value *value) {
+  auto inst = dyn_cast<Instruction>(value);
+  if (!inst || m_hoistedSet.count(inst) != 0)
+    return value;
+
+  for (Value *operand : inst->operands())
+    hoist(operand);
+
+  if (Instruction *hoisted = findHoisted(inst)) {
+    replace(inst, hoisted);
+    return hoisted;
+  }
+
+  if (m_lastHoisted) {
+    if (inst->getPrevNode() != m_lastHoisted)
+      inst->moveAfter(m_lastHoisted);
+  } else {
+    // The first hoisted instruction goes after any allocas.
+    BasicBlock &entryBlock = m_function->front();
+    BasicBlock::iterator insertPos = entryBlock.getFirstInsertionPt();
+    while (isa<AllocaInst>(*insertPos))
+      ++insertPos;
+    if (&*insertPos != inst)
+      inst->moveBefore(&*insertPos);
+  }
+  m_lastHoisted = inst;
+  m_hoistedSet.insert(inst);
+  m_hoistedMap.insert(inst);
+  return inst;
+}
+
+// =====================================================================================================================
+// Finds a hoisted instruction that computes the same value as the given one.
+//
+// @param inst : Instruction to look up
+// @returns : The hoisted instruction, or nullptr if there is none
+Instruction *PatchDescriptorLoadOpt::findHoisted(Instruction *inst) const {
+  auto it = m_hoistedMap.find(inst);
+  return it == m_hoistedMap.end() ? nullptr : *it;
+}
+
+// =====================================================================================================================
+// Replaces an instruction with a hoisted one that computes the same value. The instruction is erased at the end of
+// the pass, as it may still be in the list of instructions being visited.
+//
+// @param inst : Instruction to replace
+// @param hoisted : Hoisted instruction to replace it with
+void PatchDescriptorLoadOpt::replace(Instruction *inst, Instruction *hoisted) {
+  inst->replaceAllUsesWith(hoisted);
+  m_deadInsts.insert(inst);
+}
+
+} // namespace lgc
+
+// =====================================================================================================================
+// Initializes the pass of LLVM patching operations for descriptor load optimizations.
+INITIALIZE_PASS_BEGIN(PatchDescriptorLoadOpt, DEBUG_TYPE, "Patch LLVM for descriptor load optimizations", false, false)
+INITIALIZE_PASS_DEPENDENCY(PostDominatorTreeWrapperPass)
+INITIALIZE_PASS_END(PatchDescriptorLoadOpt, DEBUG_TYPE, "Patch LLVM for descriptor load optimizations", false, false)
@@ -0,0 +1,87 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2017-2020 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  PatchDescriptorLoadOpt.h
+ * @brief LLPC header file: contains declaration of class lgc::PatchDescriptorLoadOpt.
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "lgc/patch/Patch.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Analysis/PostDominators.h"
+
+namespace lgc {
+
+// =====================================================================================================================
+// Represents the pass of LLVM patching operations for hoisting and CSEing descriptor loads.
+//
+// Descriptor table pointers, relocation constants and the descriptor loads made from them are generated separately for
+// each resource access, and may end up in loops or in several branches of the shader. This pass hoists the descriptor
+// and pointer loads that are executed on every path through the shader (together with their address computations) to
+// the start of the shader, and then replaces duplicates of them elsewhere in the shader with the hoisted values.
+class PatchDescriptorLoadOpt final : public llvm::FunctionPass {
+public:
+  explicit PatchDescriptorLoadOpt();
+
+  void getAnalysisUsage(llvm::AnalysisUsage &analysisUsage) const override {
+    analysisUsage.addRequired<llvm::PostDominatorTreeWrapperPass>();
+    analysisUsage.setPreservesCFG();
+  }
+
+  bool runOnFunction(llvm::Function &function) override;
+
+  static char ID; // ID of this pass
+
+private:
+  PatchDescriptorLoadOpt(const PatchDescriptorLoadOpt &) = delete;
+  PatchDescriptorLoadOpt &operator=(const PatchDescriptorLoadOpt &) = delete;
+
+  // Hash and equality of instructions by what they compute, for looking up a hoisted instruction identical to another
+  struct IdenticalInstInfo : llvm::DenseMapInfo<llvm::Instruction *> {
+    static unsigned getHashValue(const llvm::Instruction *inst);
+    static bool isEqual(const llvm::Instruction *lhs, const llvm::Instruction *rhs);
+  };
+
+  bool isInvariant(llvm::Value *value) const;
+  bool isConstantLoad(llvm::Instruction *inst) const;
+  bool isDescriptorLoad(llvm::Instruction *inst) const;
+  bool isAddressComputation(llvm::Instruction *inst) const;
+  bool canHoist(llvm::Value *value, unsigned depth) const;
+  llvm::Value *hoist(llvm::Value *value);
+  llvm::Instruction *findHoisted(llvm::Instruction *inst) const;
+  void replace(llvm::Instruction *inst, llvm::Instruction *hoisted);
+
+  llvm::Function *m_function = nullptr;                                // Function being processed
+  llvm::Instruction *m_lastHoisted = nullptr;                          // Last instruction hoisted
+  llvm::SmallPtrSet<llvm::Instruction *, 16> m_hoistedSet;             // Instructions hoisted to the function start
+  llvm::DenseSet<llvm::Instruction *, IdenticalInstInfo> m_hoistedMap; // The same, for lookup by what they compute
+  llvm::SmallSetVector<llvm::Instruction *, 16> m_deadInsts;           // Instructions replaced by hoisted ones
+};
+
+} // namespace lgc
@@ -64,7 +64,11 @@
 #include "lgc/state/PipelineState.h"
 #include "lgc/state/TargetInfo.h"
 #include "lgc/util/AddressExtender.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
@@ -82,6 +86,12 @@ namespace cl {
 // GS on-chip behavior. In the future, if PAL allows hardcoded ES-GS LDS size, this option could be deprecated.
 opt<bool> InRegEsGsLdsSize("inreg-esgs-lds-size", desc("For GS on-chip, add esGsLdsSize in user data"), init(true));
 
+// -weighted-user-data-spill: When user data does not all fit in SGPRs, choose the args to spill by their usage
+// weighted by loop depth, rather than spilling everything after the point where the SGPRs run out.
+opt<bool> WeightedUserDataSpill("weighted-user-data-spill",
+                                desc("Choose user data args to spill by their loop-depth-weighted usage"),
+                                init(false));
+
 } // namespace cl
 } // namespace llvm
 
@@ -191,6 +201,10 @@ private:
 
   void determineUnspilledUserDataArgs(ArrayRef<UserDataArg> userDataArgs, ArrayRef<UserDataArg> specialUserDataArgs,
                                       IRBuilder<> &builder, SmallVectorImpl<UserDataArg> &unspilledArgs);
+  void chooseSpilledUserDataArgs(ArrayRef<UserDataArg> userDataArgs, unsigned userDataEnd, bool haveSpillTable,
+                                 SmallVectorImpl<bool> &spilledArgs);
+  uint64_t getSpillCost(const UserDataNodeUsage &usage, bool loadOncePerFunc,
+                        DenseMap<Function *, std::unique_ptr<LoopInfo>> &loopInfos);
 
   uint64_t pushFixedShaderArgTys(SmallVectorImpl<Type *> &argTys) const;
 
@@ -1442,12 +1456,19 @@ void PatchEntryPointMutate::determineUnspilledUserDataArgs(ArrayRef<UserDataArg>
   if (spillTableArg.hasValue())
     userDataEnd -= 1;
 
+  // In the weighted spill mode, choose up front which args to spill. (The layout must not depend on the uses in
+  // compute-with-calls, and spill usage is unknown until linking for an unlinked shader.)
+  SmallVector<bool, 8> spilledArgs;
+  if (cl::WeightedUserDataSpill && !isComputeWithCalls() && !m_pipelineState->isUnlinked())
+    chooseSpilledUserDataArgs(userDataArgs, userDataEnd, spillTableArg.hasValue(), spilledArgs);
+
   // See if we need to spill any user data nodes in userDataArgs, copying the unspilled ones across to unspilledArgs.
   unsigned userDataIdx = 0;
 
-  for (const UserDataArg &userDataArg : userDataArgs) {
+  for (unsigned argIdx = 0; argIdx != userDataArgs.size(); ++argIdx) {
+    const UserDataArg &userDataArg = userDataArgs[argIdx];
     unsigned afterUserDataIdx = userDataIdx + userDataArg.argDwordSize;
-    if (afterUserDataIdx > userDataEnd) {
+    if (spilledArgs.empty() ? afterUserDataIdx > userDataEnd : spilledArgs[argIdx]) {
       // Spill this node. Allocate the spill table arg.
       if (!spillTableArg.hasValue()) {
         spillTableArg =
@@ -1499,6 +1520,102 @@ void PatchEntryPointMutate::determineUnspilledUserDataArgs(ArrayRef<UserDataArg>
     unspilledArgs.insert(unspilledArgs.end(), *spillTableArg);
 }
 
+// =====================================================================================================================
+// Choose which user data args to spill in the weighted spill mode. Args that are not spill candidates, such as the
+// global table, are always kept. The candidates (push constant dwords, root descriptors and descriptor tables) are
+// then kept in decreasing order of spill cost per dword while they fit, so the cheapest ones to spill are spilled.
+//
+// @param userDataArgs : Array of UserDataArg structs for candidate args
+// @param userDataEnd : Number of user data SGPRs available for userDataArgs
+// @param haveSpillTable : Whether the spill table pointer has already been allowed for in userDataEnd
+// @param [out] spilledArgs : Whether each arg is spilled, or empty if all args fit without spilling
+void PatchEntryPointMutate::chooseSpilledUserDataArgs(ArrayRef<UserDataArg> userDataArgs, unsigned userDataEnd,
+                                                      bool haveSpillTable, SmallVectorImpl<bool> &spilledArgs) {
+  unsigned totalDwordSize = 0;
+  for (const UserDataArg &userDataArg : userDataArgs)
+    totalDwordSize += userDataArg.argDwordSize;
+  if (totalDwordSize <= userDataEnd)
+    return;
+  // Spilling anything needs the spill table pointer.
+  if (!haveSpillTable)
+    --userDataEnd;
+
+  // Get the spill cost of each candidate, identified by the entryArgIdx field that its argIndex points to.
+  auto userDataUsage = getUserDataUsage(m_shaderStage);
+  DenseMap<Function *, std::unique_ptr<LoopInfo>> loopInfos;
+  DenseMap<const unsigned *, uint64_t> spillCosts;
+  for (const UserDataNodeUsage &usage : userDataUsage->pushConstOffsets)
+    spillCosts[&usage.entryArgIdx] = getSpillCost(usage, false, loopInfos);
+  for (const UserDataNodeUsage &usage : userDataUsage->rootDescriptors)
+    spillCosts[&usage.entryArgIdx] = getSpillCost(usage, false, loopInfos);
+  for (const UserDataNodeUsage &usage : userDataUsage->descriptorTables)
+    spillCosts[&usage.entryArgIdx] = getSpillCost(usage, true, loopInfos);
+
+  SmallVector<unsigned, 8> candidates;
+  unsigned keptDwordSize = 0;
+  for (unsigned argIdx = 0; argIdx != userDataArgs.size(); ++argIdx) {
+    if (spillCosts.count(userDataArgs[argIdx].argIndex))
+      candidates.push_back(argIdx);
+    else
+      keptDwordSize += userDataArgs[argIdx].argDwordSize;
+  }
+  // If the args that cannot be spilled do not fit by themselves, leave it to the default order-based spilling.
+  if (keptDwordSize > userDataEnd)
+    return;
+
+  // Sort candidates by decreasing spill cost per dword, keeping user data order among equal ones.
+  std::stable_sort(candidates.begin(), candidates.end(), [&](unsigned lhs, unsigned rhs) {
+    return spillCosts[userDataArgs[lhs].argIndex] * userDataArgs[rhs].argDwordSize >
+           spillCosts[userDataArgs[rhs].argIndex] * userDataArgs[lhs].argDwordSize;
+  });
+
+  spilledArgs.assign(userDataArgs.size(), false);
+  for (unsigned argIdx : candidates) {
+    unsigned dwordSize = userDataArgs[argIdx].argDwordSize;
+    if (keptDwordSize + dwordSize <= userDataEnd) {
+      keptDwordSize += dwordSize;
+      continue;
+    }
+    spilledArgs[argIdx] = true;
+    LLVM_DEBUG(dbgs() << "Spilling user data " << userDataArgs[argIdx].userDataValue << " with spill cost "
+                      << spillCosts[userDataArgs[argIdx].argIndex] << "\n");
+  }
+}
+
+// =====================================================================================================================
+// Get the cost of spilling a user data node, as the number of spill table loads it needs, each weighted by loop depth.
+// A spilled descriptor table is loaded once at the start of each function that uses it; a spilled push constant dword
+// or root descriptor is loaded at each use.
+//
+// @param usage : User data usage of the node
+// @param loadOncePerFunc : Whether the spilled node is loaded once per function rather than at each use
+// @param [in/out] loopInfos : Loop info of each function, calculated as needed
+uint64_t PatchEntryPointMutate::getSpillCost(const UserDataNodeUsage &usage, bool loadOncePerFunc,
+                                             DenseMap<Function *, std::unique_ptr<LoopInfo>> &loopInfos) {
+  // Each level of loop nesting multiplies the weight of a load by 8, up to a maximum nesting depth of 4.
+  static const unsigned LoopDepthWeightShift = 3;
+  static const unsigned MaxWeightedLoopDepth = 4;
+
+  uint64_t spillCost = 0;
+  SmallPtrSet<Function *, 4> funcs;
+  for (Instruction *user : usage.users) {
+    Function *func = user->getFunction();
+    if (loadOncePerFunc) {
+      if (funcs.insert(func).second)
+        ++spillCost;
+      continue;
+    }
+    std::unique_ptr<LoopInfo> &loopInfo = loopInfos[func];
+    if (!loopInfo) {
+      DominatorTree domTree(*func);
+      loopInfo = std::make_unique<LoopInfo>(domTree);
+    }
+    unsigned loopDepth = std::min(loopInfo->getLoopDepth(user->getParent()), MaxWeightedLoopDepth);
+    spillCost += uint64_t(1) << (LoopDepthWeightShift * loopDepth);
+  }
+  return spillCost;
+}
+
 // =====================================================================================================================
 // Get UserDataUsage struct for the merged shader stage that contains the given shader stage
 //
@@ -133,6 +133,17 @@ bool PatchInOutImportExport::runOnModule(Module &module) {
     processFunction(func, shaderStage, inputCallees, otherCallees);
   }
 
+  // VS, TCS and TES all address LDS and the off-chip LDS buffer using the tessellation calculation factors, which are
+  // derived from the interfaces of all three stages.
+  if (m_hasTs) {
+    const auto &calcFactor = m_pipelineState->getShaderResourceUsage(ShaderStageTessControl)->inOutUsage.tcs.calcFactor;
+    ArrayRef<uint8_t> calcFactorData(reinterpret_cast<const uint8_t *>(&calcFactor), sizeof(calcFactor));
+    for (ShaderStage stage : {ShaderStageVertex, ShaderStageTessControl, ShaderStageTessEval}) {
+      if (Function *entryPoint = pipelineShaders->getEntryPoint(stage))
+        updateShaderHash(entryPoint, calcFactorData);
+    }
+  }
+
   for (auto callInst : m_importCalls) {
     callInst->dropAllReferences();
     callInst->eraseFromParent();
@@ -554,9 +565,8 @@ void PatchInOutImportExport::visitCallInst(CallInst &callInst) {
             loc = resUsage->inOutUsage.perPatchInputLocMap[value];
           }
         } else {
-          if (m_pipelineState->canPackInOut() &&
-              (m_shaderStage == ShaderStageFragment || m_shaderStage == ShaderStageTessControl)) {
-            // The new InOutLocationInfo is used to map scalarized FS and TCS input import as compact as possible
+          if (m_pipelineState->canPackInput(m_shaderStage)) {
+            // The new InOutLocationInfo is used to map scalarized FS, TCS and GS input import as compact as possible
             const bool isTcs = m_shaderStage == ShaderStageTessControl;
             const uint32_t elemIdxArgIdx = (isInterpolantInputImport || isTcs) ? 2 : 1;
             bool hasDynIndex = false;
@@ -623,7 +633,7 @@ void PatchInOutImportExport::visitCallInst(CallInst &callInst) {
       case ShaderStageGeometry: {
         assert(callInst.getNumArgOperands() == 3);
 
-        const unsigned compIdx = cast<ConstantInt>(callInst.getOperand(1))->getZExtValue();
+        const unsigned compIdx = cast<ConstantInt>(elemIdx ? elemIdx : callInst.getOperand(1))->getZExtValue();
 
         Value *vertexIdx = callInst.getOperand(2);
         assert(isDontCareValue(vertexIdx) == false);
@@ -863,7 +873,7 @@ void PatchInOutImportExport::visitCallInst(CallInst &callInst) {
           loc = locInfoMapIt->second.getLocation();
         }
       } else {
-        if (m_pipelineState->canPackInOut()) {
+        if (m_pipelineState->canPackOutput(m_shaderStage)) {
           const bool isVs = m_shaderStage == ShaderStageVertex;
           assert(isVs || m_shaderStage == ShaderStageTessEval);
           origLocInfo.setComponent(cast<ConstantInt>(callInst.getOperand(1))->getZExtValue());
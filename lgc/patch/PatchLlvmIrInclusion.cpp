@@ -30,13 +30,19 @@
  */
 #include "PatchLlvmIrInclusion.h"
 #include "lgc/state/Abi.h"
+#include "lgc/util/Internal.h"
 #include "llvm/IR/Constants.h"
+#include "llvm/Support/CommandLine.h"
 
 #define DEBUG_TYPE "lgc-patch-llvm-ir-inclusion"
 
 using namespace llvm;
 using namespace lgc;
 
+// -include-llvm-bc: include LLVM IR as bitcode
+static cl::opt<bool> IncludeLlvmBc("include-llvm-bc",
+                                   cl::desc("Include LLVM IR in the ELF as bitcode rather than text"), cl::init(false));
+
 namespace lgc {
 
 // =====================================================================================================================
@@ -63,6 +69,11 @@ PatchLlvmIrInclusion::PatchLlvmIrInclusion() : Patch(ID) {
 bool PatchLlvmIrInclusion::runOnModule(Module &module) {
   Patch::init(&module);
 
+  if (IncludeLlvmBc) {
+    includeBitcode();
+    return true;
+  }
+
   std::string moduleStr;
   raw_string_ostream llvmIr(moduleStr);
   llvmIr << *m_module;
@@ -80,6 +91,20 @@ bool PatchLlvmIrInclusion::runOnModule(Module &module) {
   return true;
 }
 
+// =====================================================================================================================
+// Includes the module as bitcode in the .AMDGPU.comment.llvmbc section. This is much smaller and quicker to produce
+// than the IR text; "amdllpc -print-included-llvm-ir" turns it back into text.
+void PatchLlvmIrInclusion::includeBitcode() {
+  std::string contents;
+  appendIncludedModule(*m_module, contents);
+
+  auto initializer = ConstantDataArray::getString(*m_context, contents, false);
+  auto global = new GlobalVariable(*m_module, initializer->getType(), true, GlobalValue::ExternalLinkage, initializer,
+                                   "llvmbc", nullptr, GlobalValue::NotThreadLocal, false);
+  global->setSection(Util::Abi::AmdGpuCommentLlvmBcName);
+  global->setAlignment(Align(sizeof(uint32_t)));
+}
+
 } // namespace lgc
 
 // =====================================================================================================================
@@ -49,6 +49,8 @@ public:
 private:
   PatchLlvmIrInclusion(const PatchLlvmIrInclusion &) = delete;
   PatchLlvmIrInclusion &operator=(const PatchLlvmIrInclusion &) = delete;
+
+  void includeBitcode();
 };
 
 } // namespace lgc
@@ -75,6 +75,9 @@ void PatchLoadScalarizer::getAnalysisUsage(AnalysisUsage &analysisUsage) const {
 bool PatchLoadScalarizer::runOnFunction(Function &function) {
   LLVM_DEBUG(dbgs() << "Run the pass Patch-Load-Scalarizer-Opt\n");
 
+  if (skipFunction(function))
+    return false;
+
   auto pipelineState = getAnalysis<PipelineStateWrapper>().getPipelineState(function.getParent());
   auto pipelineShaders = &getAnalysis<PipelineShaders>();
   auto shaderStage = pipelineShaders->getShaderStage(&function);
@@ -73,6 +73,9 @@ PatchPeepholeOpt::PatchPeepholeOpt() : FunctionPass(ID) {
 bool PatchPeepholeOpt::runOnFunction(Function &function) {
   LLVM_DEBUG(dbgs() << "Run the pass Patch-Peephole-Opt\n");
 
+  if (skipFunction(function))
+    return false;
+
   visit(function);
 
   const bool changed = !m_instsToErase.empty();
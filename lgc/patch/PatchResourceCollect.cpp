@@ -39,6 +39,7 @@
 #include "lgc/state/PipelineState.h"
 #include "lgc/state/TargetInfo.h"
 #include "lgc/util/Debug.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
@@ -53,6 +54,31 @@ using namespace lgc;
 // -disable-gs-onchip: disable geometry shader on-chip mode
 cl::opt<bool> DisableGsOnChip("disable-gs-onchip", cl::desc("Disable geometry shader on-chip mode"), cl::init(false));
 
+// -ngg-single-stream-gs: use NGG for geometry shader without transform feedback (no copy shader), even if NGG GS use
+// is not enabled
+static cl::opt<bool> NggSingleStreamGs("ngg-single-stream-gs",
+                                       cl::desc("Use NGG for geometry shader without transform feedback"),
+                                       cl::init(false));
+
+namespace {
+
+// =====================================================================================================================
+// Stream each map key and value for later inclusion in a hash
+template <class MapType>
+//
+// @param map : Map to stream
+// @param [in/out] stream : Stream to output map entries to
+static void streamMapEntries(MapType &map, raw_ostream &stream) {
+  size_t mapCount = map.size();
+  stream << StringRef(reinterpret_cast<const char *>(&mapCount), sizeof(mapCount));
+  for (auto mapIt : map) {
+    stream << StringRef(reinterpret_cast<const char *>(&mapIt.first), sizeof(mapIt.first));
+    stream << StringRef(reinterpret_cast<const char *>(&mapIt.second), sizeof(mapIt.second));
+  }
+}
+
+} // namespace
+
 namespace lgc {
 
 // =====================================================================================================================
@@ -83,12 +109,12 @@ bool PatchResourceCollect::runOnModule(Module &module) {
   if (m_pipelineState->canPackInOut()) {
     m_locationInfoMapManager = std::make_unique<InOutLocationInfoMapManager>();
     // Supported packing input and ouput
-    m_inOutPackStates[ShaderStageFragment][0] = true;
-    m_inOutPackStates[ShaderStageTessEval][1] = true;
-    m_inOutPackStates[ShaderStageTessControl][0] = true;
-    m_inOutPackStates[ShaderStageVertex][1] = true;
+    for (unsigned stage = 0; stage < ShaderStageGfxCount; ++stage) {
+      m_inOutPackStates[stage][0] = m_pipelineState->canPackInput(static_cast<ShaderStage>(stage));
+      m_inOutPackStates[stage][1] = m_pipelineState->canPackOutput(static_cast<ShaderStage>(stage));
+    }
 
-    // If packing {VS, TES} outputs and {TCS, FS} inputs, scalarize those outputs and inputs now.
+    // If packing {VS, TES} outputs and {TCS, GS, FS} inputs, scalarize those outputs and inputs now.
     scalarizeForInOutPacking(&module);
   }
 
@@ -124,6 +150,8 @@ bool PatchResourceCollect::runOnModule(Module &module) {
       bool gsOnChip = checkGsOnChipValidity();
       m_pipelineState->setGsOnChip(gsOnChip);
     }
+
+    updateShaderHashes(checkGsOnChip);
   }
 
   return true;
@@ -180,6 +208,14 @@ void PatchResourceCollect::setNggControl(Module *module) {
   nggControl.vertsPerSubgroup = std::min(options.nggVertsPerSubgroup, Gfx9::NggMaxThreadsPerSubgroup);
 
   if (nggControl.enableNgg) {
+    // Build NGG culling-control registers
+    buildNggCullingControlRegister(nggControl);
+
+    // NOTE: When the culling-control registers are compile-time constants rather than fetched from the primitive
+    // shader table, drop the cullers that those constants make no-ops before deciding on pass-through mode.
+    if (!nggControl.alwaysUsePrimShaderTable)
+      specializeNggCulling(nggControl);
+
     if (options.nggFlags & NggFlagForceCullingMode)
       nggControl.passthroughMode = false;
     else {
@@ -193,9 +229,6 @@ void PatchResourceCollect::setNggControl(Module *module) {
     if (!nggControl.passthroughMode)
       nggControl.passthroughMode = !canUseNggCulling(module);
 
-    // Build NGG culling-control registers
-    buildNggCullingControlRegister(nggControl);
-
     LLPC_OUTS("===============================================================================\n");
     LLPC_OUTS("// LLPC NGG control settings results\n\n");
 
@@ -271,8 +304,13 @@ bool PatchResourceCollect::canUseNgg(Module *module) {
     return false;
 
   // NGG used on GS is disabled by default.
+  // NOTE: With -ngg-single-stream-gs, GS is let through anyway. Such GS doesn't need the copy shader in NGG mode, since
+  // its outputs are exported by the primitive shader directly. There is no need to check the streams here: outputs to
+  // a stream other than the rasterization stream are only kept when transform feedback captures them, and transform
+  // feedback disables NGG below. nggControl.enableGsUse still mirrors the client's NggFlagEnableGsUse, so it stays
+  // false on this path even though NGG is enabled with GS; nothing past this check reads it other than the "-v" dump.
   const auto &options = m_pipelineState->getOptions();
-  if (hasGs && (options.nggFlags & NggFlagEnableGsUse) == 0)
+  if (hasGs && (options.nggFlags & NggFlagEnableGsUse) == 0 && !NggSingleStreamGs)
     return false;
 
   // TODO: If transform feedback is enabled, currently disable NGG.
@@ -477,6 +515,25 @@ void PatchResourceCollect::buildNggCullingControlRegister(NggControl &nggControl
   pipelineState.paClVteCntl = paClVteCntl.u32All;
 }
 
+// =====================================================================================================================
+// Specializes NGG culling on the compile-time culling-control registers built by buildNggCullingControlRegister. This
+// is only valid when those registers are not fetched from the primitive shader table at run time.
+//
+// @param [in/out] nggControl : NggControl struct
+void PatchResourceCollect::specializeNggCulling(NggControl &nggControl) {
+  assert(!nggControl.alwaysUsePrimShaderTable);
+  const auto &pipelineState = nggControl.primShaderTable.pipelineStateCb;
+
+  PaSuScModeCntl paSuScModeCntl;
+  paSuScModeCntl.u32All = pipelineState.paSuScModeCntl;
+
+  // The backface culler never culls anything if neither face is culled or if polygons are drawn as lines or points
+  // (see NggPrimShader::createBackfaceCuller), so drop it together with its viewport fetches.
+  if (nggControl.enableBackfaceCulling &&
+      (paSuScModeCntl.bits.polyMode || (!paSuScModeCntl.bits.cullFront && !paSuScModeCntl.bits.cullBack)))
+    nggControl.enableBackfaceCulling = false;
+}
+
 // =====================================================================================================================
 // Determines whether GS on-chip mode is valid for this pipeline, also computes ES-GS/GS-VS ring item size.
 bool PatchResourceCollect::checkGsOnChipValidity() {
@@ -637,8 +694,14 @@ bool PatchResourceCollect::checkGsOnChipValidity() {
       const unsigned gsVsRingItemSize =
           hasGs ? std::max(1u, 4 * gsResUsage->inOutUsage.outputMapLocCount * geometryMode.outputVertices) : 0;
 
-      const unsigned esExtraLdsSize = NggLdsManager::calcEsExtraLdsSize(m_pipelineState) / 4; // In dwords
-      const unsigned gsExtraLdsSize = NggLdsManager::calcGsExtraLdsSize(m_pipelineState) / 4; // In dwords
+      // NOTE: For ES-only, vertex cull info (ES-GS ring) is sized for a full subgroup, see expectedEsLdsSize below.
+      const unsigned vertCullInfoLdsSize = Gfx9::NggMaxThreadsPerSubgroup * esGsRingItemSize * 4;
+      const unsigned esExtraLdsSize = NggLdsManager::calcEsExtraLdsSize(m_pipelineState, vertCullInfoLdsSize) / 4;
+
+      // NOTE: Part of GS extra LDS is placed inside ES-GS ring once ES-GS ring is dead. Start by assuming ES-GS ring
+      // could be as large as the entire LDS of a subgroup, and correct it once the size of ES-GS ring is known.
+      const unsigned gsOnChipMaxLdsSize = m_pipelineState->getTargetInfo().getGpuProperty().gsOnChipMaxLdsSize;
+      unsigned gsExtraLdsSize = NggLdsManager::calcGsExtraLdsSize(m_pipelineState, gsOnChipMaxLdsSize * 4) / 4;
 
       // NOTE: Primitive amplification factor must be at least 1. And for NGG GS mode, we force number of output
       // primitives to be equal to that of output vertices regardless of the output primitive type by emitting
@@ -733,34 +796,50 @@ bool PatchResourceCollect::checkGsOnChipValidity() {
         // over-allocating LDS.
         unsigned maxVertOut = geometryMode.outputVertices;
         assert(maxVertOut >= primAmpFactor);
-        gsPrimsPerSubgroup = std::min(gsPrimsPerSubgroup, Gfx9::NggMaxThreadsPerSubgroup / maxVertOut);
+        const unsigned maxGsPrimsPerSubgroup =
+            std::min(gsPrimsPerSubgroup, Gfx9::NggMaxThreadsPerSubgroup / maxVertOut);
 
         const uint32_t gsMaxLdsSize =
             m_pipelineState->getTargetInfo().getGpuProperty().gsOnChipDefaultLdsSizePerSubgroup;
 
-        // The equation for required LDS is:
-        // LDS allocation = (esGsRingItemSize * esVertsPerSubgroup) +
-        //                  (gsVsRingItemSize * gsInstanceCount * gsPrimsPerSubgroup) +
-        //                  extraLdsSize
-        gsPrimsPerSubgroup = std::min(
-            gsPrimsPerSubgroup, (gsMaxLdsSize - esExtraLdsSize - gsExtraLdsSize) /
-                                    ((esGsRingItemSize * vertsPerPrimitive) + (gsVsRingItemSize * gsInstanceCount)));
-
-        // Let's take into consideration instancing:
-        assert(gsInstanceCount >= 1);
-        if (gsPrimsPerSubgroup < gsInstanceCount) {
-          // NOTE: If supported number of GS primitives within a subgroup is too small to allow GS
-          // instancing, we enable maximum vertex output per GS instance. This will set the register field
-          // EN_MAX_VERT_OUT_PER_GS_INSTANCE and turn off vertex reuse, restricting 1 input GS input
-          // primitive per subgroup and create 1 subgroup per GS instance.
-          enableMaxVertOut = true;
-          gsInstanceCount = 1;
-          gsPrimsPerSubgroup = 1;
-        } else {
-          gsPrimsPerSubgroup /= gsInstanceCount;
-        }
+        // NOTE: If ES-GS ring turns out to be too small to hold the part of GS extra LDS assumed to be placed inside
+        // it, GS extra LDS size goes up. In that case, GS primitives per subgroup are recalculated with the new GS
+        // extra LDS size, until it no longer changes.
+        unsigned assumedGsExtraLdsSize = 0;
+        do {
+          gsPrimsPerSubgroup = maxGsPrimsPerSubgroup;
+          gsInstanceCount = std::max(1u, geometryMode.invocations);
+          enableMaxVertOut = false;
+
+          // The equation for required LDS is:
+          // LDS allocation = (esGsRingItemSize * esVertsPerSubgroup) +
+          //                  (gsVsRingItemSize * gsInstanceCount * gsPrimsPerSubgroup) +
+          //                  extraLdsSize
+          gsPrimsPerSubgroup = std::min(
+              gsPrimsPerSubgroup, (gsMaxLdsSize - esExtraLdsSize - gsExtraLdsSize) /
+                                      ((esGsRingItemSize * vertsPerPrimitive) + (gsVsRingItemSize * gsInstanceCount)));
+
+          // Let's take into consideration instancing:
+          assert(gsInstanceCount >= 1);
+          if (gsPrimsPerSubgroup < gsInstanceCount) {
+            // NOTE: If supported number of GS primitives within a subgroup is too small to allow GS
+            // instancing, we enable maximum vertex output per GS instance. This will set the register field
+            // EN_MAX_VERT_OUT_PER_GS_INSTANCE and turn off vertex reuse, restricting 1 input GS input
+            // primitive per subgroup and create 1 subgroup per GS instance.
+            enableMaxVertOut = true;
+            gsInstanceCount = 1;
+            gsPrimsPerSubgroup = 1;
+          } else {
+            gsPrimsPerSubgroup /= gsInstanceCount;
+          }
 
-        esVertsPerSubgroup = gsPrimsPerSubgroup * vertsPerPrimitive;
+          esVertsPerSubgroup = gsPrimsPerSubgroup * vertsPerPrimitive;
+
+          // NOTE: ES-GS ring is rounded to 4-dword alignment in LDS, see NggLdsManager.
+          const unsigned esGsRingLdsSize = alignTo(esVertsPerSubgroup * esGsRingItemSize, 4u) * 4;
+          assumedGsExtraLdsSize = gsExtraLdsSize;
+          gsExtraLdsSize = NggLdsManager::calcGsExtraLdsSize(m_pipelineState, esGsRingLdsSize) / 4;
+        } while (gsExtraLdsSize > assumedGsExtraLdsSize);
       } else {
         // If GS is not present, instance count must be 1
         assert(gsInstanceCount == 1);
@@ -1193,12 +1272,20 @@ void PatchResourceCollect::visitCallInst(CallInst &callInst) {
     // Currently, do this for geometry shader.
     if (m_shaderStage == ShaderStageGeometry) {
       auto *outputValue = callInst.getArgOperand(callInst.getNumArgOperands() - 1);
-      if (isa<UndefValue>(outputValue))
+      unsigned builtInId = cast<ConstantInt>(callInst.getOperand(0))->getZExtValue();
+
+      // NOTE: Primitive ID written by geometry shader is only consumed by fragment shader. If fragment shader doesn't
+      // read it, drop it as well, so that it neither takes up room in GS-VS ring nor gets exported by copy shader.
+      // Fragment shader has already been processed at this point, since shader stages are processed in reverse order.
+      const bool unusedPrimitiveId =
+          builtInId == BuiltInPrimitiveId && !m_pipelineState->isUnlinked() &&
+          m_pipelineState->getNextShaderStage(ShaderStageGeometry) == ShaderStageFragment &&
+          !m_pipelineState->getShaderResourceUsage(ShaderStageFragment)->builtInUsage.fs.primitiveId;
+
+      if (isa<UndefValue>(outputValue) || unusedPrimitiveId)
         m_deadCalls.push_back(&callInst);
-      else {
-        unsigned builtInId = cast<ConstantInt>(callInst.getOperand(0))->getZExtValue();
+      else
         m_activeOutputBuiltIns.insert(builtInId);
-      }
     }
   }
 }
@@ -1511,6 +1598,62 @@ void PatchResourceCollect::matchGenericInOut() {
   LLPC_OUTS("\n");
 }
 
+// =====================================================================================================================
+// Fold the results of input/output matching, which depend on the adjacent shader stages, into the inter-shader data
+// hash of each shader stage.
+//
+// @param checkGsOnChip : Whether ES-GS ring sizes and GS on-chip mode were determined for this pipeline
+void PatchResourceCollect::updateShaderHashes(bool checkGsOnChip) {
+  const bool hasTs = m_pipelineState->hasShaderStage(ShaderStageTessControl) ||
+                     m_pipelineState->hasShaderStage(ShaderStageTessEval);
+  const ShaderStage esStage = hasTs ? ShaderStageTessEval : ShaderStageVertex;
+
+  for (auto stage = ShaderStageVertex; stage < ShaderStageGfxCount; stage = static_cast<ShaderStage>(stage + 1)) {
+    Function *entryPoint = m_pipelineShaders->getEntryPoint(stage);
+    if (!entryPoint)
+      continue;
+
+    const auto &inOutUsage = m_pipelineState->getShaderResourceUsage(stage)->inOutUsage;
+    std::string data;
+    raw_string_ostream stream(data);
+
+    // NOTE: VS inputs are not remapped and FS outputs only depend on the color export state, so neither of them
+    // carries data from another shader stage.
+    if (stage != ShaderStageVertex) {
+      streamMapEntries(inOutUsage.inputLocInfoMap, stream);
+      streamMapEntries(inOutUsage.perPatchInputLocMap, stream);
+      streamMapEntries(inOutUsage.builtInInputLocMap, stream);
+      streamMapEntries(inOutUsage.perPatchBuiltInInputLocMap, stream);
+    }
+    if (stage != ShaderStageFragment) {
+      streamMapEntries(inOutUsage.outputLocInfoMap, stream);
+      streamMapEntries(inOutUsage.perPatchOutputLocMap, stream);
+      streamMapEntries(inOutUsage.builtInOutputLocMap, stream);
+      streamMapEntries(inOutUsage.perPatchBuiltInOutputLocMap, stream);
+    }
+
+    if (stage == ShaderStageGeometry) {
+      // NOTE: For geometry shader, copy shader will use this special map info (from built-in outputs to
+      // locations of generic outputs).
+      streamMapEntries(inOutUsage.gs.builtInOutLocs, stream);
+    }
+
+    if (checkGsOnChip && (stage == esStage || stage == ShaderStageGeometry)) {
+      // ES and GS both address the ES-GS ring (and GS the GS-VS ring) using sizes derived from the pair of stages.
+      const auto &calcFactor = m_pipelineState->getShaderResourceUsage(ShaderStageGeometry)->inOutUsage.gs.calcFactor;
+      const unsigned gsData[] = {m_pipelineState->isGsOnChip(), calcFactor.esGsRingItemSize,
+                                 calcFactor.gsVsRingItemSize,   calcFactor.esVertsPerSubgroup,
+                                 calcFactor.gsPrimsPerSubgroup, calcFactor.esGsLdsSize,
+                                 calcFactor.gsOnChipLdsSize,    calcFactor.inputVertices,
+                                 calcFactor.primAmpFactor,      calcFactor.enableMaxVertOut};
+      stream << StringRef(reinterpret_cast<const char *>(gsData), sizeof(gsData));
+    }
+
+    stream.flush();
+    updateShaderHash(entryPoint, arrayRefFromStringRef(data));
+  }
+}
+
 // =====================================================================================================================
 // Maps special built-in input/output to generic ones.
 //
@@ -2470,7 +2613,8 @@ void PatchResourceCollect::updateOutputLocInfoMap() {
 // =====================================================================================================================
 // The process of packing input/output
 void PatchResourceCollect::packInOutLocation() {
-  if (m_shaderStage == ShaderStageFragment || m_shaderStage == ShaderStageTessControl) {
+  if (m_shaderStage == ShaderStageFragment || m_shaderStage == ShaderStageTessControl ||
+      m_shaderStage == ShaderStageGeometry) {
     fillInOutLocInfoMap();
   } else {
     if (m_shaderStage == m_pipelineState->getLastVertexProcessingStage())
@@ -2487,22 +2631,23 @@ void PatchResourceCollect::packInOutLocation() {
 }
 
 // =====================================================================================================================
-// Fill inputLocInfoMap based on FS or TCS input import calls
+// Fill inputLocInfoMap based on FS, TCS or GS input import calls
 void PatchResourceCollect::fillInOutLocInfoMap() {
   if (m_inputCalls.empty())
     return;
   const bool isTcs = m_shaderStage == ShaderStageTessControl;
   const bool isFs = m_shaderStage == ShaderStageFragment;
-  assert(isTcs || isFs);
+  assert(isTcs || isFs || m_shaderStage == ShaderStageGeometry);
   auto &inOutUsage = m_pipelineState->getShaderResourceUsage(m_shaderStage)->inOutUsage;
 
   // TCS: @llpc.input.import.generic.%Type%(i32 location, i32 locOffset, i32 elemIdx, i32 vertexIdx)
+  // GS:  @llpc.input.import.generic.%Type%(i32 location, i32 elemIdx, i32 vertexIdx)
   // FS:  @llpc.input.import.generic.%Type%(i32 location, i32 elemIdx, i32 interpMode, i32 interpLoc)
   //      @llpc.input.import.interpolant.%Type%(i32 location, i32 locOffset, i32 elemIdx,
   //                                            i32 interpMode, <2 x float> | i32 auxInterpValue)
 
   // The locations of TCS with dynamic indexing (locOffset/elemIdx) cannot be unpacked
-  // NOTE: Dynamic indexing in FS is processed to be constant in the lower pass.
+  // NOTE: Dynamic indexing in FS and GS is processed to be constant in the lower pass.
   std::vector<CallInst *> packableCalls;
   DenseSet<unsigned> unpackableLocs;
   if (isTcs) {
@@ -2528,8 +2673,9 @@ void PatchResourceCollect::fillInOutLocInfoMap() {
   // Create locationMap according to the packable calls
   m_locationInfoMapManager->createMap(packableCalls, m_shaderStage);
 
-  // Fill inputLocInfoMap of TCS/FS for the packable calls
+  // Fill inputLocInfoMap of TCS/GS/FS for the packable calls
   unsigned newLocIdx = 0;
+  DenseSet<unsigned> packedLocs;
   for (auto call : packableCalls) {
     const bool isInterpolant = isFs && call->getNumArgOperands() == 5;
     unsigned locOffset = 0;
@@ -2550,14 +2696,22 @@ void PatchResourceCollect::fillInOutLocInfoMap() {
     m_locationInfoMapManager->findMap(origLocInfo, mapIter);
     inputLocInfoMap[origLocInfo] = mapIter->second;
     newLocIdx = std::max(newLocIdx, mapIter->second.getLocation() + 1);
+    packedLocs.insert(origLocInfo.getLocation());
   }
 
-  // Fill inputLocInfoMap for the unpackable calls
-  for (auto &locInfo : inputLocInfoMap) {
-    if (locInfo.second.isInvalid()) {
-      locInfo.second.setData(0);
-      locInfo.second.setLocation(newLocIdx++);
+  // Fill inputLocInfoMap for the unpackable calls. The whole-location entries added when marking input usage are
+  // stale for locations that are entirely packed, so drop them rather than giving them a location of their own.
+  for (auto locInfoIt = inputLocInfoMap.begin(); locInfoIt != inputLocInfoMap.end();) {
+    if (locInfoIt->second.isInvalid()) {
+      const unsigned loc = locInfoIt->first.getLocation();
+      if (packedLocs.count(loc) != 0 && unpackableLocs.count(loc) == 0) {
+        locInfoIt = inputLocInfoMap.erase(locInfoIt);
+        continue;
+      }
+      locInfoIt->second.setData(0);
+      locInfoIt->second.setLocation(newLocIdx++);
     }
+    ++locInfoIt;
   }
 }
 
@@ -2686,7 +2840,7 @@ void PatchResourceCollect::reassembleOutputExportCalls() {
 }
 
 // =====================================================================================================================
-// Scalarize last vertex processing stage outputs and {TCS,FS} inputs ready for packing.
+// Scalarize last vertex processing stage outputs and {TCS,GS,FS} inputs ready for packing.
 //
 // @param [in/out] module : Module
 void PatchResourceCollect::scalarizeForInOutPacking(Module *module) {
@@ -2697,17 +2851,22 @@ void PatchResourceCollect::scalarizeForInOutPacking(Module *module) {
   for (Function &func : *module) {
     const bool isInterpolant = func.getName().startswith(lgcName::InputImportInterpolant);
     if (func.getName().startswith(lgcName::InputImportGeneric) || isInterpolant) {
-      // This is a generic (possibly interpolated) input. Find its uses in FS (VS-FS, TES-FS) or TCS.
+      // This is a generic (possibly interpolated) input. Find its uses in FS (VS-FS, TES-FS), TCS or GS.
       for (User *user : func.users()) {
         auto call = cast<CallInst>(user);
         ShaderStage shaderStage = m_pipelineShaders->getShaderStage(call->getFunction());
         const bool isFs = shaderStage == ShaderStageFragment;
         const bool isTcs = shaderStage == ShaderStageTessControl;
-        if (isFs || isTcs) {
+        const bool isGs = shaderStage == ShaderStageGeometry;
+        if ((isFs || isTcs || isGs) && m_pipelineState->canPackInput(shaderStage)) {
           // NOTE: Dynamic indexing (location offset or component) in FS is processed to be constant in lower pass.
           assert(!isInterpolant ||
                  (isInterpolant && isa<ConstantInt>(call->getOperand(1)) && isa<ConstantInt>(call->getOperand(2))));
 
+          // NOTE: GS inputs are lowered to proxy variables that are loaded whole at the start of the shader, so any
+          // dynamic indexing is done on the proxy, and the element index of a GS input import is always constant.
+          assert(!isGs || isa<ConstantInt>(call->getOperand(1)));
+
           // Collect input calls without dynamic indexing that need scalarize
           const bool hasDynIndex =
               isTcs ? (!isa<ConstantInt>(call->getOperand(1)) || !isa<ConstantInt>(call->getOperand(2))) : false;
@@ -2748,13 +2907,14 @@ void PatchResourceCollect::scalarizeForInOutPacking(Module *module) {
 
 // =====================================================================================================================
 // Scalarize a generic input.
-// This is known to be an FS generic or interpolant input or TCS input that is either a vector or 64 bit.
+// This is known to be an FS generic or interpolant input or TCS/GS input that is either a vector or 64 bit.
 //
 // @param call : Call that represents importing the generic or interpolant input
 void PatchResourceCollect::scalarizeGenericInput(CallInst *call) {
   BuilderBase builder(call->getContext());
   builder.SetInsertPoint(call);
   // TCS: @llpc.input.import.generic.%Type%(i32 location, i32 locOffset, i32 elemIdx, i32 vertexIdx)
+  // GS:  @llpc.input.import.generic.%Type%(i32 location, i32 elemIdx, i32 vertexIdx)
   // FS:  @llpc.input.import.generic.%Type%(i32 location, i32 elemIdx, i32 interpMode, i32 interpLoc)
   //      @llpc.input.import.interpolant.%Type%(i32 location, i32 locOffset, i32 elemIdx,
   //                                            i32 interpMode, <2 x float> | i32 auxInterpValue)
@@ -2762,9 +2922,10 @@ void PatchResourceCollect::scalarizeGenericInput(CallInst *call) {
   for (unsigned i = 0, end = call->getNumArgOperands(); i != end; ++i)
     args.push_back(call->getArgOperand(i));
 
-  const bool isFs = m_pipelineShaders->getShaderStage(call->getFunction()) == ShaderStageFragment;
+  const ShaderStage shaderStage = m_pipelineShaders->getShaderStage(call->getFunction());
+  const bool isFs = shaderStage == ShaderStageFragment;
   bool isInterpolant = isFs && args.size() == 5;
-  unsigned elemIdxArgIdx = isFs && !isInterpolant ? 1 : 2;
+  unsigned elemIdxArgIdx = (isFs && !isInterpolant) || shaderStage == ShaderStageGeometry ? 1 : 2;
   unsigned elemIdx = cast<ConstantInt>(args[elemIdxArgIdx])->getZExtValue();
   Type *resultTy = call->getType();
 
@@ -2931,7 +3092,8 @@ void InOutLocationInfoMapManager::createMap(const std::vector<CallInst *> &calls
 // @param shaderStage : Shader stage
 void InOutLocationInfoMapManager::addSpan(CallInst *call, ShaderStage shaderStage) {
   const bool isTcs = shaderStage == ShaderStageTessControl;
-  const bool isInterpolant = !isTcs && call->getNumArgOperands() != 4;
+  const bool isGs = shaderStage == ShaderStageGeometry;
+  const bool isInterpolant = !isTcs && !isGs && call->getNumArgOperands() != 4;
   unsigned locOffset = 0;
   unsigned compIdxArgIdx = 1;
   if (isInterpolant || isTcs) {
@@ -2945,15 +3107,16 @@ void InOutLocationInfoMapManager::addSpan(CallInst *call, ShaderStage shaderStag
   span.firstLocationInfo.setComponent(cast<ConstantInt>(call->getOperand(compIdxArgIdx))->getZExtValue());
 
   unsigned bitWidth = call->getType()->getScalarSizeInBits();
-  if (isTcs && bitWidth < 32)
+  if ((isTcs || isGs) && bitWidth < 32)
     bitWidth = 32;
   else if (bitWidth == 8)
     bitWidth = 16;
   span.compatibilityInfo.halfComponentCount = bitWidth / 16;
-  // For XX-FS, 32-bit and 16-bit are packed seperately; For VS-TCS, they are packed together
+  // For XX-FS, 32-bit and 16-bit are packed seperately; For VS-TCS and ES-GS, they are packed together as each
+  // component occupies a dword of LDS or ES-GS ring
   span.compatibilityInfo.is16Bit = bitWidth == 16;
 
-  if (!isTcs) {
+  if (!isTcs && !isGs) {
     const unsigned interpMode = cast<ConstantInt>(call->getOperand(compIdxArgIdx + 1))->getZExtValue();
     span.compatibilityInfo.isFlat = interpMode == InOutInfo::InterpModeFlat;
     span.compatibilityInfo.isCustom = interpMode == InOutInfo::InterpModeCustom;
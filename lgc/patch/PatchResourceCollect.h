@@ -70,6 +70,7 @@ private:
   bool canUseNgg(llvm::Module *module);
   bool canUseNggCulling(llvm::Module *module);
   void buildNggCullingControlRegister(NggControl &nggControl);
+  void specializeNggCulling(NggControl &nggControl);
   unsigned getVerticesPerPrimitive() const;
 
   void processShader();
@@ -82,6 +83,7 @@ private:
 
   void matchGenericInOut();
   void mapBuiltInToGenericInOut();
+  void updateShaderHashes(bool checkGsOnChip);
 
   void mapGsBuiltInOutput(unsigned builtInId, unsigned elemCount);
 
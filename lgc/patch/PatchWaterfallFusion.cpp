@@ -0,0 +1,255 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2017-2020 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  PatchWaterfallFusion.cpp
+ * @brief LLPC source file: contains implementation of class lgc::PatchWaterfallFusion.
+ ***********************************************************************************************************************
+ */
+#include "PatchWaterfallFusion.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Intrinsics.h"
+#include "llvm/IR/IntrinsicsAMDGPU.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+#define DEBUG_TYPE "lgc-patch-waterfall-fusion"
+
+using namespace lgc;
+using namespace llvm;
+
+namespace lgc {
+
+// =====================================================================================================================
+// Define static members (no initializer needed as LLVM only cares about the address of ID, never its value).
+char PatchWaterfallFusion::ID;
+
+// =====================================================================================================================
+// Pass creator, creates the pass of LLVM patching operations for waterfall loop fusion.
+FunctionPass *createPatchWaterfallFusion() {
+  return new PatchWaterfallFusion();
+}
+
+// =====================================================================================================================
+PatchWaterfallFusion::PatchWaterfallFusion() : FunctionPass(ID) {
+}
+
+// =====================================================================================================================
+// Executes this LLVM pass on the specified LLVM function.
+//
+// @param [in/out] function : Function that will run this optimization.
+bool PatchWaterfallFusion::runOnFunction(Function &function) {
+  LLVM_DEBUG(dbgs() << "Run the pass Patch-Waterfall-Fusion\n");
+
+  if (skipFunction(function))
+    return false;
+
+  bool changed = false;
+  for (BasicBlock &block : function)
+    changed |= processBlock(block);
+  return changed;
+}
+
+// =====================================================================================================================
+// Fuses runs of waterfall loops in one basic block that iterate over the same index.
+//
+// @param [in/out] block : Basic block to process
+bool PatchWaterfallFusion::processBlock(BasicBlock &block) {
+  SmallVector<IntrinsicInst *, 8> begins;
+  for (Instruction &inst : block) {
+    if (auto intrinsic = dyn_cast<IntrinsicInst>(&inst)) {
+      if (intrinsic->getIntrinsicID() == Intrinsic::amdgcn_waterfall_begin)
+        begins.push_back(intrinsic);
+    }
+  }
+  if (begins.size() < 2)
+    return false;
+
+  bool changed = false;
+  bool havePrev = false;
+  WaterfallRegion prev = {};
+  for (IntrinsicInst *begin : begins) {
+    WaterfallRegion cur = {};
+    if (!getRegion(begin, cur)) {
+      // A loop we do not understand (for example a chained multi-index one) is a barrier to fusion.
+      havePrev = false;
+      continue;
+    }
+    if (havePrev && canFuse(prev, cur)) {
+      fuse(prev, cur);
+      changed = true;
+      continue;
+    }
+    prev = cur;
+    havePrev = true;
+  }
+  return changed;
+}
+
+// =====================================================================================================================
+// Gathers the extent of a waterfall loop started by the given waterfall.begin. Only a loop over a single index whose
+// body lies entirely within the block is accepted.
+//
+// @param begin : The llvm.amdgcn.waterfall.begin call
+// @param [out] region : Filled in with the loop's extent
+// @returns : True if the loop can take part in fusion
+bool PatchWaterfallFusion::getRegion(IntrinsicInst *begin, WaterfallRegion &region) const {
+  // The first begin of a loop has a null previous token; anything else is part of a multi-index chain.
+  auto prevToken = dyn_cast<ConstantInt>(begin->getArgOperand(0));
+  if (!prevToken || !prevToken->isZero())
+    return false;
+
+  region.begin = begin;
+  region.index = begin->getArgOperand(1);
+  region.last = begin;
+  region.results.clear();
+
+  BasicBlock *block = begin->getParent();
+  auto extendTo = [&](Instruction *inst) {
+    if (region.last->comesBefore(inst))
+      region.last = inst;
+  };
+
+  for (User *user : begin->users()) {
+    auto intrinsic = dyn_cast<IntrinsicInst>(user);
+    if (!intrinsic || intrinsic->getParent() != block)
+      return false;
+    switch (intrinsic->getIntrinsicID()) {
+    case Intrinsic::amdgcn_waterfall_readfirstlane:
+      extendTo(intrinsic);
+      break;
+    case Intrinsic::amdgcn_waterfall_last_use:
+      // The store using the descriptor from last.use is the last instruction of the loop body.
+      extendTo(intrinsic);
+      for (User *descUser : intrinsic->users()) {
+        auto descUserInst = cast<Instruction>(descUser);
+        if (descUserInst->getParent() != block)
+          return false;
+        extendTo(descUserInst);
+      }
+      break;
+    case Intrinsic::amdgcn_waterfall_end:
+      extendTo(intrinsic);
+      region.results.push_back(intrinsic);
+      // An i8 vector result is cast around the waterfall.end; keep the cast back to the original type with the loop.
+      for (User *resultUser : intrinsic->users()) {
+        if (auto bitCast = dyn_cast<BitCastInst>(resultUser)) {
+          if (bitCast->getParent() == block) {
+            extendTo(bitCast);
+            region.results.push_back(bitCast);
+          }
+        }
+      }
+      break;
+    default:
+      return false;
+    }
+  }
+  return true;
+}
+
+// =====================================================================================================================
+// Checks whether a waterfall loop can be merged into the loop preceding it.
+//
+// @param prev : The earlier loop
+// @param cur : The later loop
+// @returns : True if the loops can be fused
+bool PatchWaterfallFusion::canFuse(const WaterfallRegion &prev, const WaterfallRegion &cur) const {
+  // The loops must iterate over the same index. A 64-bit index is truncated separately for each loop.
+  if (prev.index != cur.index) {
+    auto prevTrunc = dyn_cast<TruncInst>(prev.index);
+    auto curTrunc = dyn_cast<TruncInst>(cur.index);
+    if (!prevTrunc || !curTrunc || prevTrunc->getOperand(0) != curTrunc->getOperand(0) ||
+        prevTrunc->getType() != curTrunc->getType())
+      return false;
+  }
+
+  if (!prev.last->comesBefore(cur.begin))
+    return false;
+
+  // Everything between the two loops ends up inside the fused loop, where each lane runs it only in the iteration that
+  // handles its index. That is only safe for code without side effects that does not depend on the set of active lanes.
+  for (Instruction *inst = prev.last->getNextNode(); inst != cur.begin; inst = inst->getNextNode()) {
+    if (inst->mayHaveSideEffects())
+      return false;
+    if (auto call = dyn_cast<CallBase>(inst)) {
+      if (call->isConvergent() || !call->onlyReadsMemory())
+        return false;
+      if (auto intrinsic = dyn_cast<IntrinsicInst>(call)) {
+        switch (intrinsic->getIntrinsicID()) {
+        case Intrinsic::amdgcn_waterfall_begin:
+        case Intrinsic::amdgcn_waterfall_readfirstlane:
+        case Intrinsic::amdgcn_waterfall_end:
+        case Intrinsic::amdgcn_waterfall_last_use:
+          return false;
+        default:
+          break;
+        }
+      }
+    }
+  }
+
+  // The result of the earlier loop is only complete once all lanes have been through it, so nothing that would end up
+  // inside the fused loop may use it.
+  for (Instruction *result : prev.results) {
+    for (User *user : result->users()) {
+      auto userInst = cast<Instruction>(user);
+      if (userInst->getParent() != cur.begin->getParent())
+        continue;
+      if (is_contained(prev.results, userInst))
+        continue;
+      if (!cur.last->comesBefore(userInst))
+        return false;
+    }
+  }
+  return true;
+}
+
+// =====================================================================================================================
+// Merges a waterfall loop into the loop preceding it, by making it use the earlier loop's token.
+//
+// @param [in/out] prev : The earlier loop, extended to cover the later one
+// @param cur : The later loop
+void PatchWaterfallFusion::fuse(WaterfallRegion &prev, const WaterfallRegion &cur) {
+  LLVM_DEBUG(dbgs() << "Fusing waterfall loop " << *cur.begin << " into " << *prev.begin << "\n");
+
+  cur.begin->replaceAllUsesWith(prev.begin);
+  cur.begin->eraseFromParent();
+  if (cur.index != prev.index) {
+    auto trunc = cast<TruncInst>(cur.index);
+    if (trunc->use_empty())
+      trunc->eraseFromParent();
+  }
+
+  prev.last = cur.last;
+  prev.results.append(cur.results.begin(), cur.results.end());
+}
+
+} // namespace lgc
+
+// =====================================================================================================================
+// Initializes the pass of LLVM patching operations for waterfall loop fusion.
+INITIALIZE_PASS(PatchWaterfallFusion, DEBUG_TYPE, "Patch LLVM for waterfall loop fusion", false, false)
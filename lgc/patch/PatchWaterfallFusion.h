@@ -0,0 +1,71 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2017-2020 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  PatchWaterfallFusion.h
+ * @brief LLPC header file: contains declaration of class lgc::PatchWaterfallFusion.
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "lgc/patch/Patch.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/IntrinsicInst.h"
+
+namespace lgc {
+
+// =====================================================================================================================
+// Represents the pass of LLVM patching operations for fusing adjacent waterfall loops.
+//
+// Each non-uniform resource access gets its own waterfall loop when it is built. Where several consecutive accesses in
+// a block are made with the same non-uniform index, this pass merges their loops into one, so the readfirstlane and
+// exec mask iteration happens only once for the whole group.
+class PatchWaterfallFusion final : public llvm::FunctionPass {
+public:
+  explicit PatchWaterfallFusion();
+
+  bool runOnFunction(llvm::Function &function) override;
+
+  static char ID; // ID of this pass
+
+private:
+  PatchWaterfallFusion(const PatchWaterfallFusion &) = delete;
+  PatchWaterfallFusion &operator=(const PatchWaterfallFusion &) = delete;
+
+  // A single-index waterfall loop within one basic block
+  struct WaterfallRegion {
+    llvm::IntrinsicInst *begin;                        // The llvm.amdgcn.waterfall.begin call
+    llvm::Value *index;                                // The non-uniform index the loop iterates over
+    llvm::Instruction *last;                           // Last instruction of the loop body
+    llvm::SmallVector<llvm::Instruction *, 4> results; // Values produced by the loop (waterfall.end and casts of it)
+  };
+
+  bool getRegion(llvm::IntrinsicInst *begin, WaterfallRegion &region) const;
+  bool canFuse(const WaterfallRegion &prev, const WaterfallRegion &cur) const;
+  void fuse(WaterfallRegion &prev, const WaterfallRegion &cur);
+  bool processBlock(llvm::BasicBlock &block);
+};
+
+} // namespace lgc
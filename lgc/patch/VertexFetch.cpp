@@ -38,9 +38,15 @@
 #include "lgc/state/PipelineState.h"
 #include "lgc/state/TargetInfo.h"
 #include "lgc/util/Internal.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/IntrinsicsAMDGPU.h"
 #include "llvm/IR/Module.h"
+#include <algorithm>
+#include <map>
+#include <tuple>
 
 #define DEBUG_TYPE "lgc-vertex-fetch"
 
@@ -73,6 +79,14 @@ struct VertexCompFormatInfo {
   BufDataFmt compDfmt;     // Equivalent data format of each component
 };
 
+// Represents a buffer load shared between several vertex inputs of the same binding.
+struct CoalescedLoad {
+  const VertexInputDescription *description; // One of the inputs sharing the load (gives binding, stride and rate)
+  unsigned offset;                           // Byte offset of the load within the vertex
+  unsigned dwordCount;                       // Number of dwords loaded
+  Value *fetch;                              // The load, once generated
+};
+
 // =====================================================================================================================
 // Pass to lower vertex fetch calls
 class LowerVertexFetch : public ModulePass {
@@ -98,6 +112,9 @@ public:
   VertexFetchImpl(const VertexFetchImpl &) = delete;
   VertexFetchImpl &operator=(const VertexFetchImpl &) = delete;
 
+  // Plan buffer loads shared between vertex inputs
+  void planFetches(ArrayRef<const VertexInputDescription *> descriptions) override;
+
   // Generate code to fetch a vertex value
   Value *fetchVertex(Type *inputTy, const VertexInputDescription *description, unsigned location, unsigned compIdx,
                      BuilderBase &builder) override;
@@ -105,6 +122,16 @@ public:
 private:
   void initialize(PipelineState *pipelineState);
 
+  static unsigned getCoalescableDwordCount(const VertexInputDescription *description);
+
+  static unsigned getFetchCount(const VertexInputDescription *description);
+
+  Value *getVertexBufferIndex(const VertexInputDescription *description, BuilderBase &builder);
+
+  Value *fetchAttribute(const VertexInputDescription *description, bool is16bitFetch, BuilderBase &builder);
+
+  Value *fetchCoalesced(const VertexInputDescription *description, BuilderBase &builder);
+
   static VertexFormatInfo getVertexFormatInfo(const VertexInputDescription *description);
 
   // Gets variable corresponding to vertex index
@@ -134,6 +161,11 @@ private:
   Value *m_vertexIndex = nullptr;       // Vertex index
   Value *m_instanceIndex = nullptr;     // Instance index
 
+  SmallVector<CoalescedLoad, 4> m_coalescedLoads; // Buffer loads shared between vertex inputs
+  // Index into m_coalescedLoads of the load providing each dword of each vertex input that uses shared loads
+  DenseMap<const VertexInputDescription *, SmallVector<unsigned, 8>> m_coalescedInputs;
+  Instruction *m_lastCoalescedInst = nullptr; // Last instruction generated for the shared loads so far
+
   static const VertexCompFormatInfo MVertexCompFormatInfo[]; // Info table of vertex component format
   static const BufFormat MVertexFormatMap[];                 // Info table of vertex format mapping
 
@@ -379,7 +411,15 @@ bool LowerVertexFetch::runOnModule(Module &module) {
 
   if (!pipelineState->isUnlinked() || !pipelineState->getVertexInputDescriptions().empty()) {
     // Whole-pipeline compilation (or shader compilation where we were given the vertex input descriptions).
-    // Lower each vertex fetch.
+    // Plan loads shared between inputs, then lower each vertex fetch.
+    SmallVector<const VertexInputDescription *, 8> descriptions;
+    for (CallInst *call : vertexFetches) {
+      unsigned location = cast<ConstantInt>(call->getArgOperand(0))->getZExtValue();
+      if (const VertexInputDescription *description = pipelineState->findVertexInputDescription(location))
+        descriptions.push_back(description);
+    }
+    vertexFetch->planFetches(descriptions);
+
     for (CallInst *call : vertexFetches) {
       Value *vertex = nullptr;
 
@@ -517,6 +557,216 @@ VertexFetchImpl::VertexFetchImpl(LgcContext *lgcContext)
   m_fetchDefaults.double64 = ConstantVector::get({zero, zero, zero, zero, zero, zero, doubleOne0, doubleOne1});
 }
 
+// =====================================================================================================================
+// Plans buffer loads shared between the vertex inputs that are going to be fetched.
+//
+// Inputs whose channels are all 32 or 64 bits are fetched as raw dwords, so inputs that sit next to each other in the
+// same binding (such as an interleaved position/normal/texcoord layout) can share a wider load, whose result is then
+// split between them. For each binding, this covers the dwords used by such inputs with the widest aligned loads, and
+// uses the result if it takes fewer loads than fetching the inputs separately.
+//
+// @param descriptions : Descriptions of the vertex inputs to be fetched (may contain duplicates)
+void VertexFetchImpl::planFetches(ArrayRef<const VertexInputDescription *> descriptions) {
+  m_coalescedLoads.clear();
+  m_coalescedInputs.clear();
+  m_lastCoalescedInst = nullptr;
+
+  // Gather the candidate inputs, sorted so that inputs of the same binding are together in offset order.
+  SmallVector<const VertexInputDescription *, 8> candidates;
+  for (const VertexInputDescription *description : descriptions) {
+    if (getCoalescableDwordCount(description) != 0 && !is_contained(candidates, description))
+      candidates.push_back(description);
+  }
+  std::sort(candidates.begin(), candidates.end(),
+            [](const VertexInputDescription *lhs, const VertexInputDescription *rhs) {
+              return std::make_tuple(lhs->binding, lhs->stride, lhs->inputRate, lhs->offset) <
+                     std::make_tuple(rhs->binding, rhs->stride, rhs->inputRate, rhs->offset);
+            });
+
+  for (unsigned groupStart = 0; groupStart != candidates.size();) {
+    // Find the inputs sharing this binding, stride and rate.
+    const VertexInputDescription *first = candidates[groupStart];
+    unsigned groupEnd = groupStart + 1;
+    while (groupEnd != candidates.size() && candidates[groupEnd]->binding == first->binding &&
+           candidates[groupEnd]->stride == first->stride && candidates[groupEnd]->inputRate == first->inputRate)
+      ++groupEnd;
+    ArrayRef<const VertexInputDescription *> group(&candidates[groupStart], groupEnd - groupStart);
+    groupStart = groupEnd;
+    if (group.size() < 2)
+      continue;
+
+    // Gather the dwords used by the inputs.
+    std::map<unsigned, bool> usedDwords;
+    unsigned separateFetchCount = 0;
+    for (const VertexInputDescription *description : group) {
+      for (unsigned i = 0; i != getCoalescableDwordCount(description); ++i)
+        usedDwords[description->offset + i * 4] = false;
+      separateFetchCount += getFetchCount(description);
+    }
+
+    // Cover them with the widest loads that are aligned the same way as addVertexFetchInst requires for a typed fetch
+    // of the whole load, and that do not load any unused dword. The second member of usedDwords is set once the dword
+    // is covered.
+    unsigned stride = first->stride;
+    SmallVector<CoalescedLoad, 4> loads;
+    for (auto &usedDword : usedDwords) {
+      if (usedDword.second)
+        continue;
+      unsigned offset = usedDword.first;
+      unsigned dwordCount = 4;
+      for (; dwordCount > 1; dwordCount /= 2) {
+        unsigned byteSize = dwordCount * 4;
+        if (offset % byteSize != 0 || (stride != 0 && (stride % byteSize != 0 || offset + byteSize > stride)))
+          continue;
+        bool allUsed = true;
+        for (unsigned i = 1; i != dwordCount; ++i)
+          allUsed &= usedDwords.count(offset + i * 4) != 0;
+        if (allUsed)
+          break;
+      }
+      for (unsigned i = 0; i != dwordCount; ++i)
+        usedDwords[offset + i * 4] = true;
+      loads.push_back({first, offset, dwordCount, nullptr});
+    }
+    if (loads.size() >= separateFetchCount)
+      continue;
+
+    // Record which load provides each dword of each input.
+    unsigned loadBase = m_coalescedLoads.size();
+    m_coalescedLoads.append(loads.begin(), loads.end());
+    for (const VertexInputDescription *description : group) {
+      SmallVector<unsigned, 8> &inputLoads = m_coalescedInputs[description];
+      for (unsigned i = 0; i != getCoalescableDwordCount(description); ++i) {
+        unsigned dwordOffset = description->offset + i * 4;
+        unsigned loadIdx = loadBase;
+        while (m_coalescedLoads[loadIdx].offset + m_coalescedLoads[loadIdx].dwordCount * 4 <= dwordOffset)
+          ++loadIdx;
+        inputLoads.push_back(loadIdx);
+      }
+    }
+  }
+}
+
+// =====================================================================================================================
+// Gets the number of dwords of a vertex input that can be fetched as raw dwords in a shared load, or 0 if it cannot.
+//
+// @param description : Vertex input description
+unsigned VertexFetchImpl::getCoalescableDwordCount(const VertexInputDescription *description) {
+  // A typed fetch of a 32-bit integer or float channel returns the raw bits, so it is the same as an untyped fetch.
+  if (description->nfmt != BufNumFormatUint && description->nfmt != BufNumFormatSint &&
+      description->nfmt != BufNumFormatFloat)
+    return 0;
+  // The inputs must lie within the vertex, dword aligned.
+  if (description->offset % 4 != 0 || description->stride % 4 != 0 ||
+      (description->stride != 0 && description->offset >= description->stride))
+    return 0;
+
+  unsigned dwordCount = 0;
+  switch (description->dfmt) {
+  case BufDataFormat32:
+    dwordCount = 1;
+    break;
+  case BufDataFormat32_32:
+  case BufDataFormat64:
+    dwordCount = 2;
+    break;
+  case BufDataFormat32_32_32:
+    dwordCount = 3;
+    break;
+  case BufDataFormat32_32_32_32:
+  case BufDataFormat64_64:
+    dwordCount = 4;
+    break;
+  case BufDataFormat64_64_64:
+    dwordCount = 6;
+    break;
+  case BufDataFormat64_64_64_64:
+    dwordCount = 8;
+    break;
+  default:
+    return 0;
+  }
+  if (description->stride != 0 && description->offset + dwordCount * 4 > description->stride)
+    return 0;
+  return dwordCount;
+}
+
+// =====================================================================================================================
+// Gets the number of buffer loads that fetchAttribute generates for a vertex input.
+//
+// @param description : Vertex input description
+unsigned VertexFetchImpl::getFetchCount(const VertexInputDescription *description) {
+  VertexFormatInfo formatInfo = getVertexFormatInfo(description);
+  const VertexCompFormatInfo *compFormatInfo = getVertexComponentFormatInfo(formatInfo.dfmt);
+  unsigned fetchCount = 1;
+  if ((description->offset % compFormatInfo->vertexByteSize != 0 ||
+       description->stride % compFormatInfo->vertexByteSize != 0) &&
+      compFormatInfo->compDfmt != formatInfo.dfmt)
+    fetchCount = compFormatInfo->compCount;
+  if (description->dfmt == BufDataFormat64_64_64 || description->dfmt == BufDataFormat64_64_64_64)
+    fetchCount *= 2;
+  return fetchCount;
+}
+
+// =====================================================================================================================
+// Fetches a vertex input from the buffer loads it shares with other inputs, generating those loads on first use.
+// Returns the fetched channels as <n x i32> (or i32), or nullptr if planFetches did not set up shared loads for the
+// input.
+//
+// @param description : Vertex input description
+// @param builder : Builder to use to insert vertex fetch instructions
+Value *VertexFetchImpl::fetchCoalesced(const VertexInputDescription *description, BuilderBase &builder) {
+  auto it = m_coalescedInputs.find(description);
+  if (it == m_coalescedInputs.end())
+    return nullptr;
+  ArrayRef<unsigned> inputLoads = it->second;
+
+  Value *dwords[8] = {};
+  for (unsigned i = 0; i != inputLoads.size(); ++i) {
+    CoalescedLoad &load = m_coalescedLoads[inputLoads[i]];
+    if (!load.fetch) {
+      // Generate the shared load at the start of the shader (but after any exec mask setup), so that it dominates all
+      // the inputs using it. The vertex buffer table pointer and the vertex and instance indices are lazily generated
+      // at the very start of the shader, so a later shared load must not go there too: it goes after the previous one,
+      // which keeps it after the definitions it uses.
+      auto savedInsertPoint = builder.saveIP();
+      if (m_lastCoalescedInst) {
+        builder.SetInsertPoint(m_lastCoalescedInst->getNextNode());
+      } else {
+        BasicBlock::iterator insertPoint = builder.GetInsertBlock()->getParent()->front().getFirstInsertionPt();
+        while (auto intrinsic = dyn_cast<IntrinsicInst>(&*insertPoint)) {
+          if (intrinsic->getIntrinsicID() != Intrinsic::amdgcn_init_exec &&
+              intrinsic->getIntrinsicID() != Intrinsic::amdgcn_init_exec_from_input)
+            break;
+          ++insertPoint;
+        }
+        builder.SetInsertPoint(&*insertPoint);
+      }
+      Value *vbDesc = loadVertexBufferDescriptor(load.description->binding, builder);
+      Value *vbIndex = getVertexBufferIndex(load.description, builder);
+      static const unsigned LoadDfmts[] = {BUF_DATA_FORMAT_INVALID, BUF_DATA_FORMAT_32, BUF_DATA_FORMAT_32_32,
+                                           BUF_DATA_FORMAT_32_32_32, BUF_DATA_FORMAT_32_32_32_32};
+      addVertexFetchInst(vbDesc, load.dwordCount, false, vbIndex, load.offset, load.description->stride,
+                         LoadDfmts[load.dwordCount], BUF_NUM_FORMAT_UINT, &*builder.GetInsertPoint(), &load.fetch);
+      // Everything above was inserted before the builder's insert point, so the last of it is just before that.
+      m_lastCoalescedInst = builder.GetInsertPoint()->getPrevNode();
+      builder.restoreIP(savedInsertPoint);
+    }
+
+    unsigned dwordIdx = (description->offset + i * 4 - load.offset) / 4;
+    dwords[i] = load.fetch;
+    if (load.dwordCount != 1)
+      dwords[i] = builder.CreateExtractElement(load.fetch, dwordIdx);
+  }
+
+  if (inputLoads.size() == 1)
+    return dwords[0];
+  Value *vertexFetch = UndefValue::get(FixedVectorType::get(builder.getInt32Ty(), inputLoads.size()));
+  for (unsigned i = 0; i != inputLoads.size(); ++i)
+    vertexFetch = builder.CreateInsertElement(vertexFetch, dwords[i], i);
+  return vertexFetch;
+}
+
 // =====================================================================================================================
 // Executes vertex fetch operations based on the specified vertex input type and its location.
 //
@@ -529,14 +779,145 @@ Value *VertexFetchImpl::fetchVertex(Type *inputTy, const VertexInputDescription
                                     unsigned compIdx, BuilderBase &builder) {
   Value *vertex = nullptr;
   Instruction *insertPos = &*builder.GetInsertPoint();
-  auto vbDesc = loadVertexBufferDescriptor(description->binding, builder);
 
+  const bool is8bitFetch = (inputTy->getScalarSizeInBits() == 8);
+  const bool is16bitFetch = (inputTy->getScalarSizeInBits() == 16);
+
+  // Use the buffer loads shared with other inputs of the binding if the fetch planner set them up. A 16-bit fetch loads
+  // 16-bit channels rather than whole dwords, so it always does its own loads.
+  Value *vertexFetch = nullptr;
+  if (!is16bitFetch)
+    vertexFetch = fetchCoalesced(description, builder);
+  if (!vertexFetch)
+    vertexFetch = fetchAttribute(description, is16bitFetch, builder);
+
+  // Finalize vertex fetch
+  Type *basicTy = inputTy->isVectorTy() ? cast<VectorType>(inputTy)->getElementType() : inputTy;
+  const unsigned bitWidth = basicTy->getScalarSizeInBits();
+  assert(bitWidth == 8 || bitWidth == 16 || bitWidth == 32 || bitWidth == 64);
+
+  // Get default fetch values
+  Constant *defaults = nullptr;
+
+  if (basicTy->isIntegerTy()) {
+    if (bitWidth == 8)
+      defaults = m_fetchDefaults.int8;
+    else if (bitWidth == 16)
+      defaults = m_fetchDefaults.int16;
+    else if (bitWidth == 32)
+      defaults = m_fetchDefaults.int32;
+    else {
+      assert(bitWidth == 64);
+      defaults = m_fetchDefaults.int64;
+    }
+  } else if (basicTy->isFloatingPointTy()) {
+    if (bitWidth == 16)
+      defaults = m_fetchDefaults.float16;
+    else if (bitWidth == 32)
+      defaults = m_fetchDefaults.float32;
+    else {
+      assert(bitWidth == 64);
+      defaults = m_fetchDefaults.double64;
+    }
+  } else
+    llvm_unreachable("Should never be called!");
+
+  const unsigned defaultCompCount = cast<FixedVectorType>(defaults->getType())->getNumElements();
+  std::vector<Value *> defaultValues(defaultCompCount);
+
+  for (unsigned i = 0; i < defaultValues.size(); ++i) {
+    defaultValues[i] =
+        ExtractElementInst::Create(defaults, ConstantInt::get(Type::getInt32Ty(*m_context), i), "", insertPos);
+  }
+
+  // Get vertex fetch values
+  const unsigned fetchCompCount =
+      vertexFetch->getType()->isVectorTy() ? cast<FixedVectorType>(vertexFetch->getType())->getNumElements() : 1;
+  std::vector<Value *> fetchValues(fetchCompCount);
+
+  if (fetchCompCount == 1)
+    fetchValues[0] = vertexFetch;
+  else {
+    for (unsigned i = 0; i < fetchCompCount; ++i) {
+      fetchValues[i] =
+          ExtractElementInst::Create(vertexFetch, ConstantInt::get(Type::getInt32Ty(*m_context), i), "", insertPos);
+    }
+  }
+
+  // Construct vertex fetch results
+  const unsigned inputCompCount = inputTy->isVectorTy() ? cast<FixedVectorType>(inputTy)->getNumElements() : 1;
+  const unsigned vertexCompCount = inputCompCount * (bitWidth == 64 ? 2 : 1);
+
+  std::vector<Value *> vertexValues(vertexCompCount);
+
+  // NOTE: Original component index is based on the basic scalar type.
+  compIdx *= (bitWidth == 64 ? 2 : 1);
+
+  // Vertex input might take values from vertex fetch values or default fetch values
+  for (unsigned i = 0; i < vertexCompCount; i++) {
+    if (compIdx + i < fetchCompCount)
+      vertexValues[i] = fetchValues[compIdx + i];
+    else if (compIdx + i < defaultCompCount)
+      vertexValues[i] = defaultValues[compIdx + i];
+    else {
+      llvm_unreachable("Should never be called!");
+      vertexValues[i] = UndefValue::get(Type::getInt32Ty(*m_context));
+    }
+  }
+
+  if (vertexCompCount == 1)
+    vertex = vertexValues[0];
+  else {
+    Type *vertexTy = FixedVectorType::get(Type::getInt32Ty(*m_context), vertexCompCount);
+    vertex = UndefValue::get(vertexTy);
+
+    for (unsigned i = 0; i < vertexCompCount; ++i) {
+      vertex = InsertElementInst::Create(vertex, vertexValues[i], ConstantInt::get(Type::getInt32Ty(*m_context), i), "",
+                                         insertPos);
+    }
+  }
+
+  if (is8bitFetch) {
+    // NOTE: The vertex fetch results are represented as <n x i32> now. For 8-bit vertex fetch, we have to
+    // convert them to <n x i8> and the 24 high bits is truncated.
+    assert(inputTy->isIntOrIntVectorTy()); // Must be integer type
+
+    Type *vertexTy = vertex->getType();
+    Type *truncTy = Type::getInt8Ty(*m_context);
+    truncTy = vertexTy->isVectorTy()
+                  ? cast<Type>(FixedVectorType::get(truncTy, cast<FixedVectorType>(vertexTy)->getNumElements()))
+                  : truncTy;
+    vertex = new TruncInst(vertex, truncTy, "", insertPos);
+  } else if (is16bitFetch) {
+    // NOTE: The vertex fetch results are represented as <n x i32> now. For 16-bit vertex fetch, we have to
+    // convert them to <n x i16> and the 16 high bits is truncated.
+    Type *vertexTy = vertex->getType();
+    Type *truncTy = Type::getInt16Ty(*m_context);
+    truncTy = vertexTy->isVectorTy()
+                  ? cast<Type>(FixedVectorType::get(truncTy, cast<FixedVectorType>(vertexTy)->getNumElements()))
+                  : truncTy;
+    vertex = new TruncInst(vertex, truncTy, "", insertPos);
+  }
+
+  if (vertex->getType() != inputTy)
+    vertex = new BitCastInst(vertex, inputTy, "", insertPos);
+  vertex->setName("vertex" + Twine(location) + "." + Twine(compIdx));
+
+  return vertex;
+}
+
+// =====================================================================================================================
+// Gets the index of the vertex buffer element to fetch for the specified vertex input.
+//
+// @param description : Vertex input description
+// @param builder : Builder with insert point set
+Value *VertexFetchImpl::getVertexBufferIndex(const VertexInputDescription *description, BuilderBase &builder) {
   Value *vbIndex = nullptr;
   if (description->inputRate == VertexInputRateVertex) {
     // Use vertex index
     if (!m_vertexIndex) {
       auto savedInsertPoint = builder.saveIP();
-      builder.SetInsertPoint(&*insertPos->getFunction()->front().getFirstInsertionPt());
+      builder.SetInsertPoint(&*builder.GetInsertBlock()->getParent()->front().getFirstInsertionPt());
       m_vertexIndex = ShaderInputs::getVertexIndex(builder);
       builder.restoreIP(savedInsertPoint);
     }
@@ -548,7 +929,7 @@ Value *VertexFetchImpl::fetchVertex(Type *inputTy, const VertexInputDescription
       // Use instance index
       if (!m_instanceIndex) {
         auto savedInsertPoint = builder.saveIP();
-        builder.SetInsertPoint(&*insertPos->getFunction()->front().getFirstInsertionPt());
+        builder.SetInsertPoint(&*builder.GetInsertBlock()->getParent()->front().getFirstInsertionPt());
         m_instanceIndex = ShaderInputs::getInstanceIndex(builder);
         builder.restoreIP(savedInsertPoint);
       }
@@ -561,14 +942,26 @@ Value *VertexFetchImpl::fetchVertex(Type *inputTy, const VertexInputDescription
     }
   }
 
+  return vbIndex;
+}
+
+// =====================================================================================================================
+// Generates the buffer loads to fetch a single vertex input, returning the fetched channels as <n x i32> (or i32).
+//
+// @param description : Vertex input description
+// @param is16bitFetch : Whether it is 16-bit vertex fetch
+// @param builder : Builder to use to insert vertex fetch instructions
+Value *VertexFetchImpl::fetchAttribute(const VertexInputDescription *description, bool is16bitFetch,
+                                       BuilderBase &builder) {
+  Instruction *insertPos = &*builder.GetInsertPoint();
+  auto vbDesc = loadVertexBufferDescriptor(description->binding, builder);
+  Value *vbIndex = getVertexBufferIndex(description, builder);
+
   Value *vertexFetches[2] = {}; // Two vertex fetch operations might be required
   Value *vertexFetch = nullptr; // Coalesced vector by combining the results of two vertex fetch operations
 
   VertexFormatInfo formatInfo = getVertexFormatInfo(description);
 
-  const bool is8bitFetch = (inputTy->getScalarSizeInBits() == 8);
-  const bool is16bitFetch = (inputTy->getScalarSizeInBits() == 16);
-
   // Do the first vertex fetch operation
   addVertexFetchInst(vbDesc, formatInfo.numChannels, is16bitFetch, vbIndex, description->offset, description->stride,
                      formatInfo.dfmt, formatInfo.nfmt, insertPos, &vertexFetches[0]);
@@ -701,119 +1094,7 @@ Value *VertexFetchImpl::fetchVertex(Type *inputTy, const VertexInputDescription
   } else
     vertexFetch = vertexFetches[0];
 
-  // Finalize vertex fetch
-  Type *basicTy = inputTy->isVectorTy() ? cast<VectorType>(inputTy)->getElementType() : inputTy;
-  const unsigned bitWidth = basicTy->getScalarSizeInBits();
-  assert(bitWidth == 8 || bitWidth == 16 || bitWidth == 32 || bitWidth == 64);
-
-  // Get default fetch values
-  Constant *defaults = nullptr;
-
-  if (basicTy->isIntegerTy()) {
-    if (bitWidth == 8)
-      defaults = m_fetchDefaults.int8;
-    else if (bitWidth == 16)
-      defaults = m_fetchDefaults.int16;
-    else if (bitWidth == 32)
-      defaults = m_fetchDefaults.int32;
-    else {
-      assert(bitWidth == 64);
-      defaults = m_fetchDefaults.int64;
-    }
-  } else if (basicTy->isFloatingPointTy()) {
-    if (bitWidth == 16)
-      defaults = m_fetchDefaults.float16;
-    else if (bitWidth == 32)
-      defaults = m_fetchDefaults.float32;
-    else {
-      assert(bitWidth == 64);
-      defaults = m_fetchDefaults.double64;
-    }
-  } else
-    llvm_unreachable("Should never be called!");
-
-  const unsigned defaultCompCount = cast<FixedVectorType>(defaults->getType())->getNumElements();
-  std::vector<Value *> defaultValues(defaultCompCount);
-
-  for (unsigned i = 0; i < defaultValues.size(); ++i) {
-    defaultValues[i] =
-        ExtractElementInst::Create(defaults, ConstantInt::get(Type::getInt32Ty(*m_context), i), "", insertPos);
-  }
-
-  // Get vertex fetch values
-  const unsigned fetchCompCount =
-      vertexFetch->getType()->isVectorTy() ? cast<FixedVectorType>(vertexFetch->getType())->getNumElements() : 1;
-  std::vector<Value *> fetchValues(fetchCompCount);
-
-  if (fetchCompCount == 1)
-    fetchValues[0] = vertexFetch;
-  else {
-    for (unsigned i = 0; i < fetchCompCount; ++i) {
-      fetchValues[i] =
-          ExtractElementInst::Create(vertexFetch, ConstantInt::get(Type::getInt32Ty(*m_context), i), "", insertPos);
-    }
-  }
-
-  // Construct vertex fetch results
-  const unsigned inputCompCount = inputTy->isVectorTy() ? cast<FixedVectorType>(inputTy)->getNumElements() : 1;
-  const unsigned vertexCompCount = inputCompCount * (bitWidth == 64 ? 2 : 1);
-
-  std::vector<Value *> vertexValues(vertexCompCount);
-
-  // NOTE: Original component index is based on the basic scalar type.
-  compIdx *= (bitWidth == 64 ? 2 : 1);
-
-  // Vertex input might take values from vertex fetch values or default fetch values
-  for (unsigned i = 0; i < vertexCompCount; i++) {
-    if (compIdx + i < fetchCompCount)
-      vertexValues[i] = fetchValues[compIdx + i];
-    else if (compIdx + i < defaultCompCount)
-      vertexValues[i] = defaultValues[compIdx + i];
-    else {
-      llvm_unreachable("Should never be called!");
-      vertexValues[i] = UndefValue::get(Type::getInt32Ty(*m_context));
-    }
-  }
-
-  if (vertexCompCount == 1)
-    vertex = vertexValues[0];
-  else {
-    Type *vertexTy = FixedVectorType::get(Type::getInt32Ty(*m_context), vertexCompCount);
-    vertex = UndefValue::get(vertexTy);
-
-    for (unsigned i = 0; i < vertexCompCount; ++i) {
-      vertex = InsertElementInst::Create(vertex, vertexValues[i], ConstantInt::get(Type::getInt32Ty(*m_context), i), "",
-                                         insertPos);
-    }
-  }
-
-  if (is8bitFetch) {
-    // NOTE: The vertex fetch results are represented as <n x i32> now. For 8-bit vertex fetch, we have to
-    // convert them to <n x i8> and the 24 high bits is truncated.
-    assert(inputTy->isIntOrIntVectorTy()); // Must be integer type
-
-    Type *vertexTy = vertex->getType();
-    Type *truncTy = Type::getInt8Ty(*m_context);
-    truncTy = vertexTy->isVectorTy()
-                  ? cast<Type>(FixedVectorType::get(truncTy, cast<FixedVectorType>(vertexTy)->getNumElements()))
-                  : truncTy;
-    vertex = new TruncInst(vertex, truncTy, "", insertPos);
-  } else if (is16bitFetch) {
-    // NOTE: The vertex fetch results are represented as <n x i32> now. For 16-bit vertex fetch, we have to
-    // convert them to <n x i16> and the 16 high bits is truncated.
-    Type *vertexTy = vertex->getType();
-    Type *truncTy = Type::getInt16Ty(*m_context);
-    truncTy = vertexTy->isVectorTy()
-                  ? cast<Type>(FixedVectorType::get(truncTy, cast<FixedVectorType>(vertexTy)->getNumElements()))
-                  : truncTy;
-    vertex = new TruncInst(vertex, truncTy, "", insertPos);
-  }
-
-  if (vertex->getType() != inputTy)
-    vertex = new BitCastInst(vertex, inputTy, "", insertPos);
-  vertex->setName("vertex" + Twine(location) + "." + Twine(compIdx));
-
-  return vertex;
+  return vertexFetch;
 }
 
 // =====================================================================================================================
@@ -116,6 +116,10 @@ Module *PipelineState::irLink(ArrayRef<Module *> modules, bool unlinked) {
       if (!func.isDeclaration() && !isShaderEntryPoint(&func))
         setShaderStage(&func, stage);
     }
+
+    // If the module came from an earlier shader compile, its shader modes are in IR metadata. Read them
+    // into this PipelineState now, as generate() hands this object straight to the middle-end.
+    getShaderModes()->readModesFromShader(module, stage);
   }
 
 #ifndef NDEBUG
@@ -125,8 +129,10 @@ Module *PipelineState::irLink(ArrayRef<Module *> modules, bool unlinked) {
   assert(shaderStageMask == getShaderStageMask());
 #endif
 
-  // If the front-end was using a BuilderRecorder, record pipeline state into IR metadata.
-  if (!m_noReplayer)
+  // The pipeline state stays in this object, and generate() gives it directly to PipelineStateWrapper.
+  // Only for -emit-lgc do we need to record it into IR metadata, so the lgc tool can read it back.
+  m_irLinked = true;
+  if (m_emitLgc)
     record(modules[0]);
 
   // If there is only one shader, just change the name on its module and return it.
@@ -135,8 +141,8 @@ Module *PipelineState::irLink(ArrayRef<Module *> modules, bool unlinked) {
     pipelineModule = modules[0];
     pipelineModule->setModuleIdentifier("lgcPipeline");
   } else {
-    // Create an empty module then link each shader module into it. We record pipeline state into IR
-    // metadata before the link, to avoid problems with a Constant for an immutable descriptor value
+    // Create an empty module then link each shader module into it. For -emit-lgc, we record pipeline state
+    // into IR metadata before the link, to avoid problems with a Constant for an immutable descriptor value
     // disappearing when modules are deleted.
     bool result = true;
     pipelineModule = new Module("lgcPipeline", getContext());
@@ -189,26 +195,35 @@ bool PipelineState::generate(std::unique_ptr<Module> pipelineModule, raw_pwrite_
   assert(otherElf.getBuffer().empty() && "otherElf not supported yet");
 
   m_lastError.clear();
+  m_cancelled = false;
   unsigned passIndex = 1000;
   Timer *patchTimer = timers.size() >= 1 ? timers[0] : nullptr;
   Timer *optTimer = timers.size() >= 2 ? timers[1] : nullptr;
   Timer *codeGenTimer = timers.size() >= 3 ? timers[2] : nullptr;
 
+  // A compile cancelled before it gets here does not run the mandatory passes either.
+  if (m_cancelCheck && m_cancelCheck()) {
+    m_cancelled = true;
+    setError("Compile cancelled");
+    return false;
+  }
+
   // Set up "whole pipeline" passes, where we have a single module representing the whole pipeline.
   std::unique_ptr<PassManager> passMgr(PassManager::Create());
   passMgr->setPassIndex(&passIndex);
+  passMgr->setCancelCheck(m_cancelCheck);
   passMgr->add(createTargetTransformInfoWrapperPass(getLgcContext()->getTargetMachine()->getTargetIRAnalysis()));
 
   // Manually add a target-aware TLI pass, so optimizations do not think that we have library functions.
   getLgcContext()->preparePassManager(&*passMgr);
 
   // Manually add a PipelineStateWrapper pass.
-  // If we were not using BuilderRecorder, give our PipelineState to it. (In the BuilderRecorder case,
-  // the first time PipelineStateWrapper is used, it allocates its own PipelineState and populates
-  // it by reading IR metadata.)
+  // If the front-end set up our state and called irLink() (with or without BuilderRecorder), give our
+  // PipelineState to it. (Where the module was read from IR, such as in the lgc tool, the first time
+  // PipelineStateWrapper is used, it allocates its own PipelineState and populates it by reading IR metadata.)
   PipelineStateWrapper *pipelineStateWrapper = new PipelineStateWrapper(getLgcContext());
   passMgr->add(pipelineStateWrapper);
-  if (m_noReplayer)
+  if (m_noReplayer || m_irLinked)
     pipelineStateWrapper->setPipelineState(this);
 
   if (m_emitLgc) {
@@ -217,6 +232,17 @@ bool PipelineState::generate(std::unique_ptr<Module> pipelineModule, raw_pwrite_
     passMgr->stop();
   }
 
+  // If the client checks the shader cache per stage, seed each shader function's inter-shader data hash with its input
+  // shader hash. Passes that make decisions based on data from other shader stages fold that data into the hash, which
+  // is then handed to the client by PatchCheckShaderCache.
+  if (checkShaderCacheFunc) {
+    for (Function &func : *pipelineModule) {
+      ShaderStage stage = getShaderStage(&func);
+      if (!func.isDeclaration() && stage != ShaderStageInvalid && stage < ShaderStageGfxCount)
+        setShaderHash(&func, getShaderOptions(stage).hash);
+    }
+  }
+
   // Get a BuilderReplayer pass if needed.
   ModulePass *replayerPass = nullptr;
   if (!m_noReplayer)
@@ -228,11 +254,25 @@ bool PipelineState::generate(std::unique_ptr<Module> pipelineModule, raw_pwrite_
   // Add pass to clear pipeline state from IR
   passMgr->add(createPipelineStateClearer());
 
-  // Code generation.
+  // Code generation. For a fast compile, temporarily drop the target machine to the lowest optimization level, which
+  // gets the fast instruction selection path and the fast register allocator. The target machine is shared by all
+  // compiles in this LgcContext, so its level is restored afterwards.
+  TargetMachine *targetMachine = getLgcContext()->getTargetMachine();
+  CodeGenOpt::Level savedOptLevel = targetMachine->getOptLevel();
+  if (getOptions().fastCompile)
+    targetMachine->setOptLevel(CodeGenOpt::None);
   getLgcContext()->addTargetPasses(*passMgr, codeGenTimer, outStream);
 
   // Run the "whole pipeline" passes.
   passMgr->run(*pipelineModule);
+  targetMachine->setOptLevel(savedOptLevel);
+
+  // If the compile was cancelled, the remaining optional passes were skipped, so the output is not what the client
+  // asked for.
+  if (passMgr->isCancelled()) {
+    m_cancelled = true;
+    setError("Compile cancelled");
+  }
 
   // See if there was a recoverable error.
   if (getLastError() != "")
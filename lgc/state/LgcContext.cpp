@@ -32,22 +32,27 @@
 #include "lgc/Builder.h"
 #include "lgc/PassManager.h"
 #include "lgc/patch/Patch.h"
+#include "lgc/state/Abi.h"
 #include "lgc/state/PassManagerCache.h"
 #include "lgc/state/PipelineState.h"
 #include "lgc/state/TargetInfo.h"
 #include "lgc/util/Debug.h"
 #include "lgc/util/Internal.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriterPass.h"
 #include "llvm/CodeGen/CommandFlags.h"
 #include "llvm/IR/IRPrintingPasses.h"
+#include "llvm/IR/LegacyPassManager.h"
 #include "llvm/InitializePasses.h"
+#include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
+#include "llvm/Transforms/IPO.h"
 
 #define DEBUG_TYPE "lgc-context"
 
@@ -322,3 +327,138 @@ PassManagerCache *LgcContext::getPassManagerCache() {
     m_passManagerCache = new PassManagerCache(this);
   return m_passManagerCache;
 }
+
+// =====================================================================================================================
+// Parse the modules in the contents of a .AMDGPU.comment.llvmbc section, which is a sequence of modules, more than one
+// if it was merged from two ELFs.
+//
+// @param data : Section contents
+// @param context : LLVM context to parse the modules in
+// @param [out] modules : Parsed modules, appended to
+// @returns : False if the contents are malformed
+static bool parseIncludedModules(StringRef data, LLVMContext &context,
+                                 SmallVectorImpl<std::unique_ptr<Module>> &modules) {
+  while (data.size() >= sizeof(Util::Abi::LlvmBcHeader)) {
+    Util::Abi::LlvmBcHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != Util::Abi::LlvmBcMagic || header.dataSize > data.size() - sizeof(header))
+      return false;
+    StringRef moduleData = data.substr(sizeof(header), header.dataSize);
+    data = data.drop_front(std::min(data.size(), alignTo(sizeof(header) + header.dataSize, sizeof(uint32_t))));
+
+    Expected<std::unique_ptr<Module>> module =
+        parseBitcodeFile(MemoryBufferRef(moduleData, Util::Abi::AmdGpuCommentLlvmBcName), context);
+    if (!module) {
+      consumeError(module.takeError());
+      return false;
+    }
+    modules.push_back(std::move(*module));
+  }
+  return true;
+}
+
+// =====================================================================================================================
+// Remove the fragment shader entry-point from a module, or all the other shader entry-points, along with anything
+// that is then unused.
+//
+// @param [in/out] module : Module to strip
+// @param keepFragment : True to keep only the fragment shader, false to keep everything but the fragment shader
+static void stripIncludedModule(Module &module, bool keepFragment) {
+  for (Function &func : module) {
+    if (func.isDeclaration())
+      continue;
+    switch (func.getCallingConv()) {
+    case CallingConv::AMDGPU_PS:
+      if (!keepFragment)
+        func.deleteBody();
+      break;
+    case CallingConv::AMDGPU_LS:
+    case CallingConv::AMDGPU_HS:
+    case CallingConv::AMDGPU_ES:
+    case CallingConv::AMDGPU_GS:
+    case CallingConv::AMDGPU_VS:
+      if (keepFragment)
+        func.deleteBody();
+      break;
+    default:
+      break;
+    }
+  }
+
+  legacy::PassManager passMgr;
+  passMgr.add(createGlobalDCEPass());
+  passMgr.run(module);
+}
+
+// =====================================================================================================================
+// Get the name of the ELF section in which a pipeline ELF includes LLVM IR as bitcode.
+StringRef LgcContext::getIncludedLlvmIrSectionName() {
+  return Util::Abi::AmdGpuCommentLlvmBcName;
+}
+
+// =====================================================================================================================
+// Print the LLVM IR that a pipeline ELF includes as bitcode as LLVM IR text.
+//
+// @param elf : Pipeline ELF
+// @param [out] out : Stream to print the LLVM IR to
+bool LgcContext::printIncludedLlvmIr(StringRef elf, raw_ostream &out) {
+  auto objectOrErr = object::ObjectFile::createELFObjectFile(MemoryBufferRef(elf, ""));
+  if (!objectOrErr) {
+    consumeError(objectOrErr.takeError());
+    return false;
+  }
+
+  bool found = false;
+  for (const object::SectionRef &section : (*objectOrErr)->sections()) {
+    Expected<StringRef> name = section.getName();
+    if (!name) {
+      consumeError(name.takeError());
+      continue;
+    }
+    if (*name != Util::Abi::AmdGpuCommentLlvmBcName)
+      continue;
+    Expected<StringRef> contents = section.getContents();
+    if (!contents) {
+      consumeError(contents.takeError());
+      return false;
+    }
+
+    LLVMContext context;
+    SmallVector<std::unique_ptr<Module>, 2> modules;
+    if (!parseIncludedModules(*contents, context, modules))
+      return false;
+    for (const auto &module : modules) {
+      out << *module;
+      found = true;
+    }
+  }
+  return found;
+}
+
+// =====================================================================================================================
+// Merge the .AMDGPU.comment.llvmbc sections of a non-fragment ELF and a fragment ELF that are being merged into one
+// pipeline ELF. Each module from the non-fragment ELF has its own fragment shader removed, and each module from the
+// fragment ELF keeps only its fragment shader, so the merged section has exactly one of each shader.
+//
+// @param nonFragmentSection : Contents of the section in the non-fragment ELF
+// @param fragmentSection : Contents of the section in the fragment ELF
+// @param [out] merged : Contents of the merged section
+bool LgcContext::mergeIncludedLlvmIr(StringRef nonFragmentSection, StringRef fragmentSection, std::string &merged) {
+  LLVMContext context;
+  SmallVector<std::unique_ptr<Module>, 2> nonFragmentModules;
+  SmallVector<std::unique_ptr<Module>, 2> fragmentModules;
+  if (!parseIncludedModules(nonFragmentSection, context, nonFragmentModules) ||
+      !parseIncludedModules(fragmentSection, context, fragmentModules))
+    return false;
+
+  merged.clear();
+  for (auto &module : nonFragmentModules) {
+    stripIncludedModule(*module, false);
+    appendIncludedModule(*module, merged);
+  }
+  for (auto &module : fragmentModules) {
+    stripIncludedModule(*module, true);
+    appendIncludedModule(*module, merged);
+  }
+  return true;
+}
@@ -38,9 +38,11 @@
 #include "lgc/state/AbiUnlinked.h"
 #include "lgc/state/PipelineState.h"
 #include "lgc/state/TargetInfo.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/IR/CallingConv.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
+#include <algorithm>
 
 #define DEBUG_TYPE "lgc-pal-metadata"
 
@@ -130,12 +132,76 @@ void PalMetadata::record(Module *module) {
   namedMeta->addOperand(abiMetaNode);
 }
 
+// =====================================================================================================================
+// How a uint node in incoming PAL metadata is merged into an existing node with the same key
+enum class MergeRule : unsigned {
+  Or,         // "or" the values together
+  Max,        // Take the max value
+  Min,        // Take the min value
+  KeepDest,   // Keep the existing value
+  PgmRsrc1,   // SPI_SHADER_PGM_RSRC1_*: max the VGPRS and SGPRS fields, "or" the rest
+  PsInputEna, // SPI_PS_INPUT_ENA/ADDR: take the new value unless it comes from glue code
+};
+
+// Registers with a merge rule other than MergeRule::Or, sorted by register number.
+static const std::pair<unsigned, MergeRule> RegisterMergeRules[] = {
+    {mmSPI_SHADER_PGM_RSRC1_PS, MergeRule::PgmRsrc1},
+    {mmSPI_SHADER_PGM_RSRC1_VS, MergeRule::PgmRsrc1},
+    {mmSPI_SHADER_PGM_RSRC1_GS, MergeRule::PgmRsrc1},
+    {mmSPI_SHADER_PGM_RSRC1_ES, MergeRule::PgmRsrc1},
+    {mmSPI_SHADER_PGM_RSRC1_HS, MergeRule::PgmRsrc1},
+    {mmSPI_SHADER_PGM_RSRC1_LS, MergeRule::PgmRsrc1},
+    {mmSPI_PS_INPUT_ENA, MergeRule::PsInputEna},
+    {mmSPI_PS_INPUT_ADDR, MergeRule::PsInputEna},
+    // Ignore new value of VGT_SHADER_STAGES_EN from glue shader, as it might accidentally make the VS
+    // wave32. (This relies on the glue shader's PAL metadata being merged into the vertex-processing
+    // half-pipeline, rather than the other way round.)
+    {mmVGT_SHADER_STAGES_EN, MergeRule::KeepDest},
+};
+
+// =====================================================================================================================
+// Get the merge rule for a uint node in PAL metadata. The rule depends only on the map key, so registers are looked up
+// in a sorted table and string keys in a map built on first use, rather than testing every candidate in turn.
+//
+// @param mapKey : Key of the node in its parent map
+static MergeRule getMergeRule(msgpack::DocNode mapKey) {
+  if (mapKey.getKind() == msgpack::Type::UInt) {
+    unsigned regNum = mapKey.getUInt();
+    auto it = std::lower_bound(std::begin(RegisterMergeRules), std::end(RegisterMergeRules), regNum,
+                               [](const std::pair<unsigned, MergeRule> &rule, unsigned regNum) {
+                                 return rule.first < regNum;
+                               });
+    if (it != std::end(RegisterMergeRules) && it->first == regNum)
+      return it->second;
+    return MergeRule::Or;
+  }
+
+  if (mapKey.isString()) {
+    static const StringMap<MergeRule> KeyMergeRules = {
+        // For .userdatalimit, register counts, and register limits, take the max value.
+        {Util::Abi::PipelineMetadataKey::UserDataLimit, MergeRule::Max},
+        {Util::Abi::HardwareStageMetadataKey::SgprCount, MergeRule::Max},
+        {Util::Abi::HardwareStageMetadataKey::SgprLimit, MergeRule::Max},
+        {Util::Abi::HardwareStageMetadataKey::VgprCount, MergeRule::Max},
+        {Util::Abi::HardwareStageMetadataKey::VgprLimit, MergeRule::Max},
+        // For .spillthreshold, take the min value.
+        {Util::Abi::PipelineMetadataKey::SpillThreshold, MergeRule::Min},
+    };
+    auto it = KeyMergeRules.find(mapKey.getString());
+    if (it != KeyMergeRules.end())
+      return it->second;
+  }
+  return MergeRule::Or;
+}
+
 // =====================================================================================================================
 // Read blob as PAL metadata and merge it into existing PAL metadata (if any)
 //
 // @param blob : MsgPack PAL metadata to merge
 // @param isGlueCode : True if the blob is was generated for glue code.
 void PalMetadata::mergeFromBlob(llvm::StringRef blob, bool isGlueCode) {
+  assert(std::is_sorted(std::begin(RegisterMergeRules), std::end(RegisterMergeRules)));
+
   // Use msgpack::Document::readFromBlob to read the new MsgPack PAL metadata, merging it into the msgpack::Document
   // we already have. We pass it a lambda that determines how to cope with merge conflicts, which returns:
   // -1: failure
@@ -144,6 +210,47 @@ void PalMetadata::mergeFromBlob(llvm::StringRef blob, bool isGlueCode) {
   bool success = m_document->readFromBlob(
       blob, /*multi=*/false,
       [isGlueCode](msgpack::DocNode *destNode, msgpack::DocNode srcNode, msgpack::DocNode mapKey) {
+        // The common case: two uints, merged according to their key.
+        if (destNode->getKind() == msgpack::Type::UInt && srcNode.getKind() == msgpack::Type::UInt) {
+          uint64_t destValue = destNode->getUInt();
+          uint64_t srcValue = srcNode.getUInt();
+          switch (getMergeRule(mapKey)) {
+          case MergeRule::Or:
+            *destNode = destValue | srcValue;
+            break;
+          case MergeRule::Max:
+            *destNode = std::max(destValue, srcValue);
+            break;
+          case MergeRule::Min:
+            *destNode = std::min(destValue, srcValue);
+            break;
+          case MergeRule::KeepDest:
+            break;
+          case MergeRule::PgmRsrc1: {
+            // For the RSRC1 registers, we need to consider the VGPRS and SGPRS fields separately, and max them.
+            // This happens when linking in a glue shader. Register values are 32 bits wide.
+            SPI_SHADER_PGM_RSRC1 destRsrc1;
+            SPI_SHADER_PGM_RSRC1 srcRsrc1;
+            SPI_SHADER_PGM_RSRC1 origRsrc1;
+            origRsrc1.u32All = static_cast<unsigned>(destValue);
+            srcRsrc1.u32All = static_cast<unsigned>(srcValue);
+            destRsrc1.u32All = origRsrc1.u32All | srcRsrc1.u32All;
+            destRsrc1.bits.VGPRS = std::max(origRsrc1.bits.VGPRS, srcRsrc1.bits.VGPRS);
+            destRsrc1.bits.SGPRS = std::max(origRsrc1.bits.SGPRS, srcRsrc1.bits.SGPRS);
+            if (isGlueCode) {
+              // The float mode should come from the body of the shader and not the glue code.
+              destRsrc1.bits.FLOAT_MODE = origRsrc1.bits.FLOAT_MODE;
+            }
+            *destNode = destRsrc1.u32All;
+            break;
+          }
+          case MergeRule::PsInputEna:
+            if (!isGlueCode)
+              *destNode = srcValue;
+            break;
+          }
+          return 0;
+        }
         // Allow array and map merging.
         if (srcNode.isMap() && destNode->isMap())
           return 0;
@@ -168,67 +275,8 @@ void PalMetadata::mergeFromBlob(llvm::StringRef blob, bool isGlueCode) {
             return 0;
           }
         }
-        // Disallow merging other than uint.
-        if (destNode->getKind() != msgpack::Type::UInt || srcNode.getKind() != msgpack::Type::UInt)
-          return -1;
-        // Special cases of uint merging.
-        if (mapKey.getKind() == msgpack::Type::UInt) {
-          switch (mapKey.getUInt()) {
-          case mmVGT_SHADER_STAGES_EN:
-            // Ignore new value of VGT_SHADER_STAGES_EN from glue shader, as it might accidentally make the VS
-            // wave32. (This relies on the glue shader's PAL metadata being merged into the vertex-processing
-            // half-pipeline, rather than the other way round.)
-            return 0;
-          case mmSPI_SHADER_PGM_RSRC1_LS:
-          case mmSPI_SHADER_PGM_RSRC1_HS:
-          case mmSPI_SHADER_PGM_RSRC1_ES:
-          case mmSPI_SHADER_PGM_RSRC1_GS:
-          case mmSPI_SHADER_PGM_RSRC1_VS:
-          case mmSPI_SHADER_PGM_RSRC1_PS: {
-            // For the RSRC1 registers, we need to consider the VGPRS and SGPRS fields separately, and max them.
-            // This happens when linking in a glue shader.
-            SPI_SHADER_PGM_RSRC1 destRsrc1;
-            SPI_SHADER_PGM_RSRC1 srcRsrc1;
-            SPI_SHADER_PGM_RSRC1 origRsrc1;
-            origRsrc1.u32All = destNode->getUInt();
-            srcRsrc1.u32All = srcNode.getUInt();
-            destRsrc1.u32All = origRsrc1.u32All | srcRsrc1.u32All;
-            destRsrc1.bits.VGPRS = std::max(origRsrc1.bits.VGPRS, srcRsrc1.bits.VGPRS);
-            destRsrc1.bits.SGPRS = std::max(origRsrc1.bits.SGPRS, srcRsrc1.bits.SGPRS);
-            if (isGlueCode) {
-              // The float mode should come from the body of the shader and not the glue code.
-              destRsrc1.bits.FLOAT_MODE = origRsrc1.bits.FLOAT_MODE;
-            }
-            *destNode = srcNode.getDocument()->getNode(destRsrc1.u32All);
-            return 0;
-          }
-          case mmSPI_PS_INPUT_ENA:
-          case mmSPI_PS_INPUT_ADDR: {
-            if (!isGlueCode) {
-              *destNode = srcNode.getUInt();
-            }
-            return 0;
-          }
-          }
-        } else if (mapKey.isString()) {
-          // For .userdatalimit, register counts, and register limits, take the max value.
-          if (mapKey.getString() == Util::Abi::PipelineMetadataKey::UserDataLimit ||
-              mapKey.getString() == Util::Abi::HardwareStageMetadataKey::SgprCount ||
-              mapKey.getString() == Util::Abi::HardwareStageMetadataKey::SgprLimit ||
-              mapKey.getString() == Util::Abi::HardwareStageMetadataKey::VgprCount ||
-              mapKey.getString() == Util::Abi::HardwareStageMetadataKey::VgprLimit) {
-            *destNode = std::max(destNode->getUInt(), srcNode.getUInt());
-            return 0;
-          }
-          // For .spillthreshold, take the min value.
-          if (mapKey.getString() == Util::Abi::PipelineMetadataKey::SpillThreshold) {
-            *destNode = std::min(destNode->getUInt(), srcNode.getUInt());
-            return 0;
-          }
-        }
-        // Default behavior for uint nodes: "or" the values together.
-        *destNode = destNode->getUInt() | srcNode.getUInt();
-        return 0;
+        // Disallow merging anything else.
+        return -1;
       });
   assert(success && "Bad PAL metadata format");
   ((void)success);
@@ -1038,13 +1038,63 @@ bool PipelineState::isTessOffChip() {
 void PipelineState::initializePackInOut() {
   // Pack input/output requirements:
   // 1) -pack-in-out option is on
-  // 2) It supports VS-FS, VS-TCS-TES-(FS)
-  if (PackInOut && !m_unlinked && hasShaderStage(ShaderStageVertex) && !hasShaderStage(ShaderStageGeometry)) {
+  // 2) It supports VS-FS, VS-TCS-TES-(FS), VS-GS-(FS), VS-TCS-TES-GS-(FS)
+  if (PackInOut && !m_unlinked && hasShaderStage(ShaderStageVertex)) {
     const unsigned nextStage = getNextShaderStage(ShaderStageVertex);
-    m_packInOut = nextStage == ShaderStageFragment || nextStage == ShaderStageTessControl;
+    m_packInOut = nextStage == ShaderStageFragment || nextStage == ShaderStageTessControl ||
+                  nextStage == ShaderStageGeometry;
   }
 }
 
+// =====================================================================================================================
+// Check whether the generic inputs of the specified shader stage are packed
+//
+// @param shaderStage : Shader stage
+bool PipelineState::canPackInput(ShaderStage shaderStage) {
+  if (!m_packInOut)
+    return false;
+  // NOTE: GS outputs are written to the GS-VS ring and exported by the copy shader, which does not support packing,
+  // so FS inputs are only packed when there is no GS.
+  if (shaderStage == ShaderStageFragment)
+    return !hasShaderStage(ShaderStageGeometry);
+  return shaderStage == ShaderStageTessControl || shaderStage == ShaderStageGeometry;
+}
+
+// =====================================================================================================================
+// Check whether the generic outputs of the specified shader stage are packed
+//
+// @param shaderStage : Shader stage
+bool PipelineState::canPackOutput(ShaderStage shaderStage) {
+  if (!m_packInOut)
+    return false;
+  return shaderStage == ShaderStageVertex || shaderStage == ShaderStageTessEval;
+}
+
+// =====================================================================================================================
+// Gets the wave size chosen by the fixed per-stage rules for the specified shader stage
+//
+// @param stage : Shader stage
+unsigned PipelineState::getDefaultShaderWaveSize(ShaderStage stage) {
+  unsigned waveSize = getTargetInfo().getGpuProperty().waveSize;
+
+  if (getTargetInfo().getGfxIpVersion().major >= 10) {
+    if (stage == ShaderStageFragment) {
+      // Per programming guide, it's recommended to use wave64 for fragment shader.
+      waveSize = 64;
+    } else if (hasShaderStage(ShaderStageGeometry)) {
+      // Legacy (non-NGG) hardware path for GS does not support wave32.
+      waveSize = 64;
+    }
+
+    // Experimental data from performance tuning show that wave64 is more efficient than wave32 in most cases for CS
+    // on GFX10.3. Hence, set the wave size to wave64 by default.
+    if (getTargetInfo().getGfxIpVersion().minor >= 3 && stage == ShaderStageCompute)
+      waveSize = 64;
+  }
+
+  return waveSize;
+}
+
 // =====================================================================================================================
 // Gets wave size for the specified shader stage
 //
@@ -1063,22 +1113,12 @@ unsigned PipelineState::getShaderWaveSize(ShaderStage stage) {
 
   if (getTargetInfo().getGfxIpVersion().major >= 10) {
     // NOTE: GPU property wave size is used in shader, unless:
-    //  1) A stage-specific default is preferred.
+    //  1) A stage-specific default is preferred, or WaveSizeHeuristic selected a wave size for the shader.
     //  2) If specified by tuning option, use the specified wave size.
     //  3) If gl_SubgroupSize is used in shader, use the specified subgroup size when required.
-
-    if (stage == ShaderStageFragment) {
-      // Per programming guide, it's recommended to use wave64 for fragment shader.
-      waveSize = 64;
-    } else if (hasShaderStage(ShaderStageGeometry)) {
-      // Legacy (non-NGG) hardware path for GS does not support wave32.
-      waveSize = 64;
-    }
-
-    // Experimental data from performance tuning show that wave64 is more efficient than wave32 in most cases for CS
-    // on GFX10.3. Hence, set the wave size to wave64 by default.
-    if (getTargetInfo().getGfxIpVersion().minor >= 3 && stage == ShaderStageCompute)
-      waveSize = 64;
+    waveSize = getDefaultShaderWaveSize(stage);
+    if (m_waveSizeSelection[stage].waveSize != 0)
+      waveSize = m_waveSizeSelection[stage].waveSize;
 
     unsigned waveSizeOption = getShaderOptions(stage).waveSize;
     if (waveSizeOption != 0)
@@ -49,6 +49,7 @@ static const char ComputeShaderModeMetadataName[] = "llpc.compute.mode";
 // Clear shader modes
 void ShaderModes::clear() {
   memset(m_commonShaderModes, 0, sizeof(m_commonShaderModes));
+  m_setStageMask = 0;
 }
 
 // =====================================================================================================================
@@ -59,7 +60,7 @@ void ShaderModes::clear() {
 void ShaderModes::setCommonShaderMode(ShaderStage stage, const CommonShaderMode &commonShaderMode) {
   auto modes = MutableArrayRef<CommonShaderMode>(m_commonShaderModes);
   modes[stage] = commonShaderMode;
-  m_anySet = true;
+  m_setStageMask |= 1U << stage;
 }
 
 // =====================================================================================================================
@@ -180,27 +181,32 @@ void ShaderModes::record(Module *module) {
 
 // =====================================================================================================================
 // Read shader modes (common and specific) from a shader IR module, but only if no modes have been set
-// in this ShaderModes. This is used to handle the case that the shader module comes from an earlier
-// shader compile, and it had its ShaderModes recorded into IR then.
+// for that shader stage in this ShaderModes. This is used to handle the case that the shader module comes from
+// an earlier shader compile, and it had its ShaderModes recorded into IR then.
 //
 // @param module : LLVM module
 // @param stage : Shader stage
 void ShaderModes::readModesFromShader(Module *module, ShaderStage stage) {
-  // Bail if any modes have been set, which would mean that this is a full pipeline compile.
-  if (m_anySet)
+  // Bail if modes have been set for this stage, which would mean that it was translated in this pipeline compile.
+  if (m_setStageMask & (1U << stage))
     return;
 
   // First the common state.
   std::string metadataName =
       std::string(CommonShaderModeMetadataPrefix) + getShaderStageAbbreviation(static_cast<ShaderStage>(stage));
-  PipelineState::readNamedMetadataArrayOfInt32(module, metadataName, m_commonShaderModes[stage]);
+  if (PipelineState::readNamedMetadataArrayOfInt32(module, metadataName, m_commonShaderModes[stage]) != 0)
+    m_setStageMask |= 1U << stage;
 
   // Then the specific shader modes.
   switch (stage) {
   case ShaderStageTessControl:
-  case ShaderStageTessEval:
-    PipelineState::readNamedMetadataArrayOfInt32(module, TessellationModeMetadataName, m_tessellationMode);
+  case ShaderStageTessEval: {
+    // Merge with the tessellation mode from the other tessellation shader, which may have been set already.
+    TessellationMode tessellationMode = {};
+    PipelineState::readNamedMetadataArrayOfInt32(module, TessellationModeMetadataName, tessellationMode);
+    setTessellationMode(tessellationMode);
     break;
+  }
   case ShaderStageGeometry:
     PipelineState::readNamedMetadataArrayOfInt32(module, GeometryShaderModeMetadataName, m_geometryShaderMode);
     break;
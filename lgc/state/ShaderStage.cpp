@@ -36,6 +36,7 @@
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/MD5.h"
 
 using namespace lgc;
 using namespace llvm;
@@ -43,6 +44,8 @@ using namespace llvm;
 // Named metadata node used on a function to show what shader stage it is part of
 namespace {
 const static char ShaderStageMetadata[] = "lgc.shaderstage";
+// Named metadata node used on a function to hold the hash of the inter-shader data used to compile it
+const static char ShaderHashMetadata[] = "llpc.hash";
 } // anonymous namespace
 
 // =====================================================================================================================
@@ -94,6 +97,62 @@ bool lgc::isShaderEntryPoint(const Function *func) {
   return !func->isDeclaration() && func->getDLLStorageClass() == GlobalValue::DLLExportStorageClass;
 }
 
+// =====================================================================================================================
+// Seed the inter-shader data hash of a function with its input shader hash.
+//
+// @param [in/out] func : Function to set the hash on
+// @param hash : 128-bit input shader hash, as two 64-bit words
+void lgc::setShaderHash(Function *func, ArrayRef<uint64_t> hash) {
+  assert(hash.size() == 2);
+  Type *int64Ty = Type::getInt64Ty(func->getContext());
+  auto hashMetaNode = MDNode::get(func->getContext(), {ConstantAsMetadata::get(ConstantInt::get(int64Ty, hash[0])),
+                                                       ConstantAsMetadata::get(ConstantInt::get(int64Ty, hash[1]))});
+  func->setMetadata(ShaderHashMetadata, hashMetaNode);
+}
+
+// =====================================================================================================================
+// Update the inter-shader data hash of a function with data obtained from other shader stages.
+//
+// @param [in/out] func : Function to update the hash of
+// @param data : Inter-shader data that was used to make a decision when compiling the function
+void lgc::updateShaderHash(Function *func, ArrayRef<uint8_t> data) {
+  uint64_t hash[2] = {};
+  if (!getShaderHash(func, hash))
+    return;
+
+  MD5 hasher;
+  hasher.update(ArrayRef<uint8_t>(reinterpret_cast<const uint8_t *>(hash), sizeof(hash)));
+  hasher.update(data);
+  MD5::MD5Result result;
+  hasher.final(result);
+  hash[0] = result.low();
+  hash[1] = result.high();
+  setShaderHash(func, hash);
+}
+
+// =====================================================================================================================
+// Get the inter-shader data hash of a function. Returns false if the function is not tracking its hash.
+//
+// @param func : Function to get the hash of
+// @param [out] hash : 128-bit hash, as two 64-bit words
+bool lgc::getShaderHash(const Function *func, MutableArrayRef<uint64_t> hash) {
+  assert(hash.size() == 2);
+  MDNode *hashMetaNode = func->getMetadata(ShaderHashMetadata);
+  if (!hashMetaNode)
+    return false;
+  hash[0] = mdconst::extract<ConstantInt>(hashMetaNode->getOperand(0))->getZExtValue();
+  hash[1] = mdconst::extract<ConstantInt>(hashMetaNode->getOperand(1))->getZExtValue();
+  return true;
+}
+
+// =====================================================================================================================
+// Stop tracking the inter-shader data hash of a function.
+//
+// @param [in/out] func : Function to remove the hash from
+void lgc::clearShaderHash(Function *func) {
+  func->setMetadata(ShaderHashMetadata, nullptr);
+}
+
 // =====================================================================================================================
 // Gets name string of the abbreviation for the specified shader stage
 //
@@ -159,8 +218,11 @@ Function *lgc::addFunctionArgs(Function *oldFunc, Type *retTy, ArrayRef<Type *>
   newFunc->setAttributes(AttributeList::get(oldFunc->getContext(), oldAttrList.getFnAttributes(),
                                             oldAttrList.getRetAttributes(), argAttrs));
 
-  // Set the shader stage on the new function (implemented with IR metadata).
+  // Set the shader stage on the new function (implemented with IR metadata), and carry over the inter-shader data
+  // hash if it is being tracked.
   setShaderStage(newFunc, getShaderStage(oldFunc));
+  if (MDNode *hashMetaNode = oldFunc->getMetadata(ShaderHashMetadata))
+    newFunc->setMetadata(ShaderHashMetadata, hashMetaNode);
 
   // Replace uses of the old args.
   // Set inreg attributes correctly. We have to use removeAttr because arg attributes are actually attached
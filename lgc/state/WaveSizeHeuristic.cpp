@@ -0,0 +1,313 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2020 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  WaveSizeHeuristic.cpp
+ * @brief LLPC source file: contains implementation of class lgc::WaveSizeHeuristic.
+ ***********************************************************************************************************************
+ */
+#include "lgc/state/WaveSizeHeuristic.h"
+#include "lgc/BuiltIns.h"
+#include "lgc/state/IntrinsDefs.h"
+#include "lgc/state/TargetInfo.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/Analysis/PostDominators.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+
+#define DEBUG_TYPE "lgc-wave-size-heuristic"
+
+using namespace llvm;
+using namespace lgc;
+
+// -enable-wave-size-heuristic: select wave32 or wave64 per shader from modeled occupancy and utilization
+// NOTE: The selection is made when the recorded Builder calls are replayed. With -use-builder-recorder=false, the
+// front-end lowers Builder calls directly with the fixed per-stage wave sizes, so this option has no effect there.
+static cl::opt<bool>
+    EnableWaveSizeHeuristic("enable-wave-size-heuristic",
+                            cl::desc("Select wave32 or wave64 per shader from modeled occupancy and utilization "
+                                     "(only when Builder calls are recorded and replayed)"),
+                            cl::init(false));
+
+// Model of a GFX10 SIMD. The VGPR file holds 1024 registers per lane for wave32, or 512 for wave64.
+static const unsigned VgprFileSizeWave32 = 1024;
+static const unsigned VgprFileSizeWave64 = 512;
+static const unsigned VgprGranuleWave32 = 8;
+static const unsigned VgprGranuleWave64 = 4;
+static const unsigned MaxVgprsPerWave = 256;
+static const unsigned SimdsPerCu = 2;
+
+// Number of lanes in flight per SIMD beyond which more waves are assumed not to hide any more latency.
+static const unsigned LatencyHidingLanes = 512;
+
+// Fraction (in percent) of the issue slots spent on code under divergent control flow that wave64 is assumed to
+// waste compared to wave32, because both sides of a branch are more likely to be taken by some lane of the wave.
+static const unsigned DivergencePenaltyWave64 = 25;
+
+// The other wave size is only chosen if its modeled score beats the default by this percentage.
+static const unsigned SelectionMarginPercent = 10;
+
+// =====================================================================================================================
+// Select the wave size of each shader stage in the pipeline and record the selection in the pipeline state.
+//
+// @param [in/out] module : Pipeline module, before Builder calls are replayed
+void WaveSizeHeuristic::run(Module &module) {
+  if (!EnableWaveSizeHeuristic || m_pipelineState->getTargetInfo().getGfxIpVersion().major < 10)
+    return;
+
+  // The legacy GS path needs wave64 for all stages, and gl_SubgroupSize pins the wave size through the shader options.
+  // A compute library has to use the wave size of the shaders that call it, which are compiled separately.
+  if (m_pipelineState->hasShaderStage(ShaderStageGeometry) ||
+      m_pipelineState->getShaderModes()->getAnyUseSubgroupSize() || m_pipelineState->isComputeLibrary())
+    return;
+
+  StageStats stageStats[ShaderStageCompute + 1] = {};
+  for (Function &func : module) {
+    if (func.isDeclaration())
+      continue;
+    ShaderStage stage = getShaderStage(&func);
+    if (stage == ShaderStageInvalid || stage > ShaderStageCompute)
+      continue;
+    collectStats(func, stageStats[stage]);
+  }
+
+  // With tessellation, VS and TCS are merged into one hardware shader, so they must use the same wave size. Select it
+  // for the TCS from the statistics of both, and give the VS the same selection below.
+  const bool hasTcs = m_pipelineState->hasShaderStage(ShaderStageTessControl);
+  if (hasTcs) {
+    StageStats &vsStats = stageStats[ShaderStageVertex];
+    StageStats &tcsStats = stageStats[ShaderStageTessControl];
+    tcsStats.instCount += vsStats.instCount;
+    tcsStats.divergentInstCount += vsStats.divergentInstCount;
+    tcsStats.vgprEstimate = std::max(tcsStats.vgprEstimate, vsStats.vgprEstimate);
+    tcsStats.usesWaveSize |= vsStats.usesWaveSize || m_pipelineState->getShaderOptions(ShaderStageVertex).waveSize != 0;
+  }
+
+  const unsigned ldsSize = getLdsSize(module);
+
+  for (ShaderStage stage : {ShaderStageTessControl, ShaderStageTessEval, ShaderStageVertex, ShaderStageCompute}) {
+    if (stage == ShaderStageVertex && hasTcs) {
+      m_pipelineState->setWaveSizeSelection(stage, m_pipelineState->getWaveSizeSelection(ShaderStageTessControl));
+      continue;
+    }
+
+    const StageStats &stats = stageStats[stage];
+    // Fragment shaders keep the wave64 recommended by the programming guide. Shaders that can observe the wave size,
+    // and shaders with an explicit wave size in their tuning options, are left alone.
+    if (!m_pipelineState->hasShaderStage(stage) || stats.instCount == 0 || stats.usesWaveSize ||
+        m_pipelineState->getShaderOptions(stage).waveSize != 0)
+      continue;
+
+    WaveSizeSelection selection = {};
+    selection.defaultWaveSize = m_pipelineState->getDefaultShaderWaveSize(stage);
+    selection.vgprEstimate = stats.vgprEstimate;
+    selection.ldsSize = stage == ShaderStageCompute ? ldsSize : 0;
+    selection.divergentPercent = stats.divergentInstCount * 100 / stats.instCount;
+    selection.score32 = getScore(stage, 32, selection.vgprEstimate, selection.ldsSize, selection.divergentPercent);
+    selection.score64 = getScore(stage, 64, selection.vgprEstimate, selection.ldsSize, selection.divergentPercent);
+
+    // Keep the default unless the other wave size is modeled to be clearly better.
+    unsigned defaultScore = selection.defaultWaveSize == 32 ? selection.score32 : selection.score64;
+    unsigned otherScore = selection.defaultWaveSize == 32 ? selection.score64 : selection.score32;
+    selection.waveSize = selection.defaultWaveSize;
+    if (otherScore * 100 > defaultScore * (100 + SelectionMarginPercent))
+      selection.waveSize = selection.defaultWaveSize == 32 ? 64 : 32;
+
+    LLVM_DEBUG(dbgs() << getShaderStageAbbreviation(stage) << ": wave" << selection.waveSize << " (default wave"
+                      << selection.defaultWaveSize << ", vgprs " << selection.vgprEstimate << ", lds "
+                      << selection.ldsSize << ", divergent " << selection.divergentPercent << "%, score "
+                      << selection.score32 << "/" << selection.score64 << ")\n");
+    m_pipelineState->setWaveSizeSelection(stage, selection);
+  }
+}
+
+// =====================================================================================================================
+// Gather statistics from one function of a shader stage.
+//
+// @param func : Function to gather statistics from
+// @param [in/out] stats : Statistics of the shader stage
+void WaveSizeHeuristic::collectStats(Function &func, StageStats &stats) {
+  // Instructions in blocks that do not post-dominate the entry block are only run by some of the lanes that enter the
+  // function, so they are under possibly divergent control flow. Divergence analysis is not usable before the
+  // Builder calls are replayed, so uniform branches are counted as well.
+  PostDominatorTree postDomTree(func);
+  BasicBlock *entryBlock = &func.getEntryBlock();
+  for (BasicBlock &block : func) {
+    const bool isDivergent = !postDomTree.dominates(&block, entryBlock);
+    for (Instruction &inst : block) {
+      ++stats.instCount;
+      if (isDivergent)
+        ++stats.divergentInstCount;
+      if (auto call = dyn_cast<CallInst>(&inst)) {
+        // A call to a function that is compiled separately has to use the wave size that function was compiled with.
+        Function *callee = call->getCalledFunction();
+        if (!callee || (callee->isDeclaration() && !callee->isIntrinsic() && !callee->getName().startswith("lgc.")))
+          stats.usesWaveSize = true;
+        else
+          stats.usesWaveSize |= isWaveSizeObservable(*callee, *call);
+      }
+    }
+  }
+  stats.vgprEstimate = std::max(stats.vgprEstimate, estimateVgprs(func));
+}
+
+// =====================================================================================================================
+// Estimate the number of VGPRs per lane that a function needs, from the peak number of dwords held by values that are
+// live at the same time within a basic block. Every value is counted as a VGPR, except i1 values, which live in SGPR
+// lane masks.
+//
+// @param func : Function to estimate
+unsigned WaveSizeHeuristic::estimateVgprs(Function &func) {
+  const DataLayout &dataLayout = func.getParent()->getDataLayout();
+  auto getDwordCount = [&](Value *value) -> unsigned {
+    Type *ty = value->getType();
+    if (!ty->isSized() || ty->getScalarType()->isIntegerTy(1))
+      return 0;
+    return (dataLayout.getTypeSizeInBits(ty).getFixedSize() + 31) / 32;
+  };
+
+  unsigned maxLiveDwords = 0;
+  for (BasicBlock &block : func) {
+    // Start with the values defined in this block that are used in another one.
+    DenseSet<Value *> liveValues;
+    unsigned liveDwords = 0;
+    for (Instruction &inst : block) {
+      for (User *user : inst.users()) {
+        auto userInst = dyn_cast<Instruction>(user);
+        if (userInst && (userInst->getParent() != &block || isa<PHINode>(userInst))) {
+          liveValues.insert(&inst);
+          liveDwords += getDwordCount(&inst);
+          break;
+        }
+      }
+    }
+    maxLiveDwords = std::max(maxLiveDwords, liveDwords);
+
+    // Walk backwards, ending the live range of each value at its definition and starting those of its operands.
+    for (Instruction &inst : reverse(block)) {
+      if (liveValues.erase(&inst))
+        liveDwords -= getDwordCount(&inst);
+      if (isa<PHINode>(inst))
+        continue;
+      for (Value *operand : inst.operands()) {
+        if ((isa<Instruction>(operand) || isa<Argument>(operand)) && liveValues.insert(operand).second)
+          liveDwords += getDwordCount(operand);
+      }
+      maxLiveDwords = std::max(maxLiveDwords, liveDwords);
+    }
+  }
+  return std::min(maxLiveDwords, MaxVgprsPerWave);
+}
+
+// =====================================================================================================================
+// Check whether a call can observe the wave size, so that choosing a different one would change the result of the
+// shader rather than just its performance.
+//
+// @param callee : Called function
+// @param call : Call instruction
+bool WaveSizeHeuristic::isWaveSizeObservable(Function &callee, CallInst &call) {
+  StringRef name = callee.getName();
+  if (!name.startswith("lgc.create."))
+    return false;
+  if (name.contains("subgroup"))
+    return true;
+  if (name.startswith("lgc.create.read.builtin.input")) {
+    auto builtIn = dyn_cast<ConstantInt>(call.getArgOperand(0));
+    if (!builtIn)
+      return true;
+    switch (builtIn->getZExtValue()) {
+    case BuiltInNumSubgroups:
+    case BuiltInSubgroupEqMask:
+    case BuiltInSubgroupGeMask:
+    case BuiltInSubgroupGtMask:
+    case BuiltInSubgroupId:
+    case BuiltInSubgroupLeMask:
+    case BuiltInSubgroupLocalInvocationId:
+    case BuiltInSubgroupLtMask:
+    case BuiltInSubgroupSize:
+      return true;
+    default:
+      return false;
+    }
+  }
+  return false;
+}
+
+// =====================================================================================================================
+// Get the LDS size in bytes used by the shared variables of the module.
+//
+// @param module : Pipeline module
+unsigned WaveSizeHeuristic::getLdsSize(Module &module) {
+  unsigned ldsSize = 0;
+  for (GlobalVariable &global : module.globals()) {
+    if (global.getType()->getAddressSpace() == ADDR_SPACE_LOCAL && !global.use_empty())
+      ldsSize += module.getDataLayout().getTypeAllocSize(global.getValueType());
+  }
+  return ldsSize;
+}
+
+// =====================================================================================================================
+// Get the modeled throughput of a shader stage with the specified wave size: the number of useful lanes in flight per
+// SIMD, up to the number needed to hide latency.
+//
+// @param stage : Shader stage
+// @param waveSize : Wave size to model
+// @param vgprs : Estimated VGPRs per lane
+// @param ldsSize : LDS bytes used per workgroup
+// @param divergentPercent : Percentage of instructions under possibly divergent control flow
+unsigned WaveSizeHeuristic::getScore(ShaderStage stage, unsigned waveSize, unsigned vgprs, unsigned ldsSize,
+                                     unsigned divergentPercent) {
+  const bool isWave32 = waveSize == 32;
+  const unsigned maxWaves = m_pipelineState->getTargetInfo().getGfxIpVersion().minor >= 3 ? 16 : 20;
+
+  // Occupancy limited by VGPRs.
+  const unsigned granule = isWave32 ? VgprGranuleWave32 : VgprGranuleWave64;
+  const unsigned vgprFileSize = isWave32 ? VgprFileSizeWave32 : VgprFileSizeWave64;
+  unsigned waves = std::min(maxWaves, vgprFileSize / static_cast<unsigned>(alignTo(std::max(vgprs, 1U), granule)));
+
+  // For compute, occupancy limited by LDS, and the lanes wasted in a partially filled last wave of each workgroup.
+  unsigned usefulLanesPercent = 100;
+  if (stage == ShaderStageCompute) {
+    const auto &mode = m_pipelineState->getShaderModes()->getComputeShaderMode();
+    const unsigned workgroupSize =
+        std::max(mode.workgroupSizeX, 1U) * std::max(mode.workgroupSizeY, 1U) * std::max(mode.workgroupSizeZ, 1U);
+    const unsigned wavesPerWorkgroup = divideCeil(workgroupSize, waveSize);
+    if (ldsSize != 0) {
+      const unsigned workgroupsPerCu = m_pipelineState->getTargetInfo().getGpuProperty().ldsSizePerCu / ldsSize;
+      waves = std::min(waves, std::max(workgroupsPerCu * wavesPerWorkgroup / SimdsPerCu, 1U));
+    }
+    usefulLanesPercent = workgroupSize * 100 / (wavesPerWorkgroup * waveSize);
+  }
+
+  if (!isWave32)
+    usefulLanesPercent = usefulLanesPercent * (100 - DivergencePenaltyWave64 * divergentPercent / 100) / 100;
+
+  return std::min(waves * waveSize, LatencyHidingLanes) * usefulLanesPercent / 100;
+}
@@ -28,6 +28,7 @@
  * @brief LLPC source file: contains implementation of LLPC internal-use utility functions.
  ***********************************************************************************************************************
  */
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/Support/raw_os_ostream.h"
 
@@ -38,6 +39,7 @@
 #endif
 
 #include "lgc/BuilderBase.h"
+#include "lgc/state/Abi.h"
 #include "lgc/util/Internal.h"
 
 #define DEBUG_TYPE "lgc-internal"
@@ -235,4 +237,24 @@ Type *getVgprTy(Type *ty) {
   return ty;
 }
 
+// =====================================================================================================================
+// Appends a module, as bitcode with its LlvmBcHeader, to the contents of a .AMDGPU.comment.llvmbc section. The module
+// is padded to 4 bytes.
+//
+// @param module : Module to append
+// @param [in/out] contents : Section contents to append to
+void appendIncludedModule(Module &module, std::string &contents) {
+  SmallString<0> bitcode;
+  raw_svector_ostream bitcodeStream(bitcode);
+  WriteBitcodeToFile(module, bitcodeStream);
+
+  Util::Abi::LlvmBcHeader header = {};
+  header.magic = Util::Abi::LlvmBcMagic;
+  header.dataSize = bitcode.size();
+
+  contents.append(reinterpret_cast<const char *>(&header), sizeof(header));
+  contents += bitcode;
+  contents.resize(alignTo(contents.size(), sizeof(uint32_t)));
+}
+
 } // namespace lgc
@@ -31,6 +31,8 @@
 #include "lgc/PassManager.h"
 #include "lgc/util/Debug.h"
 #include "llvm/Analysis/CFGPrinter.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/OptBisect.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/Support/CommandLine.h"
 
@@ -60,6 +62,34 @@ using namespace llvm;
 
 namespace {
 
+// =====================================================================================================================
+// Pass gate used while running a pass manager that has a cancel check. LLVM asks the gate before running each
+// optional pass on each function or module (via skipFunction/skipModule), so this is where the cancel check gets
+// polled between passes. Once cancelled, every further optional pass is skipped; passes that are needed to get
+// valid output at all do not consult the gate and still run, but without optimizations they are quick.
+class CancelPassGate final : public OptPassGate {
+public:
+  CancelPassGate(const std::function<bool()> &cancelCheck, OptPassGate &chainedGate)
+      : m_cancelCheck(cancelCheck), m_chainedGate(chainedGate) {}
+
+  bool shouldRunPass(const Pass *pass, StringRef irDescription) override {
+    if (!m_cancelled && m_cancelCheck())
+      m_cancelled = true;
+    if (m_cancelled)
+      return false;
+    return !m_chainedGate.isEnabled() || m_chainedGate.shouldRunPass(pass, irDescription);
+  }
+
+  bool isEnabled() const override { return true; }
+
+  bool isCancelled() const { return m_cancelled; }
+
+private:
+  const std::function<bool()> &m_cancelCheck; // Function to check whether the compile has been cancelled
+  OptPassGate &m_chainedGate;                 // Gate that was installed in the LLVM context before this one
+  bool m_cancelled = false;                   // Whether the compile has been cancelled
+};
+
 // =====================================================================================================================
 // LLPC's legacy::PassManager override.
 // This is the implementation subclass of the PassManager class declared in PassManager.h
@@ -69,11 +99,16 @@ public:
   ~PassManagerImpl() override {}
 
   void setPassIndex(unsigned *passIndex) override { m_passIndex = passIndex; }
+  void setCancelCheck(std::function<bool()> cancelCheck) override { m_cancelCheck = cancelCheck; }
+  bool isCancelled() const override { return m_cancelled; }
   void add(Pass *pass) override;
   void stop() override;
+  bool run(Module &module) override;
 
 private:
   bool m_stopped = false;               // Whether we have already stopped adding new passes.
+  bool m_cancelled = false;             // Whether the last run was cancelled
+  std::function<bool()> m_cancelCheck;  // Function to check whether the compile has been cancelled
   AnalysisID m_dumpCfgAfter = nullptr;  // -dump-cfg-after pass id
   AnalysisID m_printModule = nullptr;   // Pass id of dump pass "Print Module IR"
   AnalysisID m_jumpThreading = nullptr; // Pass id of opt pass "Jump Threading"
@@ -170,3 +205,23 @@ void PassManagerImpl::add(Pass *pass) {
 void PassManagerImpl::stop() {
   m_stopped = true;
 }
+
+// =====================================================================================================================
+// Run the passes on a module. If there is a cancel check, it is polled between passes through a pass gate installed
+// in the LLVM context for the duration of the run.
+//
+// @param [in/out] module : Module to run the passes on
+bool PassManagerImpl::run(Module &module) {
+  m_cancelled = false;
+  if (!m_cancelCheck)
+    return legacy::PassManager::run(module);
+
+  LLVMContext &context = module.getContext();
+  OptPassGate &savedGate = context.getOptPassGate();
+  CancelPassGate cancelGate(m_cancelCheck, savedGate);
+  context.setOptPassGate(cancelGate);
+  bool changed = legacy::PassManager::run(module);
+  context.setOptPassGate(savedGate);
+  m_cancelled = cancelGate.isCancelled();
+  return changed;
+}
@@ -0,0 +1,159 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2020 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcAsyncBuilder.cpp
+ * @brief LLPC source file: contains implementation of class Llpc::AsyncBuilder.
+ ***********************************************************************************************************************
+ */
+#include "llpcAsyncBuilder.h"
+#include <cassert>
+
+#define DEBUG_TYPE "llpc-async-builder"
+
+namespace Llpc {
+
+// Set on a compiler thread when a build's callback on that thread destroys the async builder (by destroying the
+// compiler). The thread has then been detached, and must not touch the destroyed builder once the callback returns.
+static thread_local bool BuilderDestroyedOnThisThread = false;
+
+// =====================================================================================================================
+// Start the compiler threads.
+//
+// @param threadCount : Number of compiler threads; 0 means one per hardware thread
+AsyncBuilder::AsyncBuilder(unsigned threadCount) {
+  if (threadCount == 0)
+    threadCount = std::max(1U, std::thread::hardware_concurrency());
+  for (unsigned i = 0; i < threadCount; ++i)
+    m_threads.emplace_back(&AsyncBuilder::workerLoop, this);
+}
+
+// =====================================================================================================================
+// Cancel all queued builds, then wait for the running ones to finish. If this is called from a build's callback on
+// one of the compiler threads, that thread cannot wait for itself, so it is detached instead, and it exits as soon
+// as the callback returns.
+AsyncBuilder::~AsyncBuilder() {
+  std::vector<Job> cancelledJobs;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_shutdown = true;
+    for (auto &queue : m_queues) {
+      for (auto &job : queue)
+        cancelledJobs.push_back(std::move(job));
+      queue.clear();
+    }
+  }
+  m_jobReady.notify_all();
+
+  for (auto &job : cancelledJobs)
+    job.cancel();
+
+  for (auto &thread : m_threads) {
+    if (thread.get_id() == std::this_thread::get_id()) {
+      BuilderDestroyedOnThisThread = true;
+      thread.detach();
+    } else
+      thread.join();
+  }
+}
+
+// =====================================================================================================================
+// Queue a build.
+//
+// @param priority : Priority of the build
+// @param run : Function that runs the build and reports its result
+// @param cancel : Function that reports cancellation of the build
+// @returns : Handle of the queued build
+AsyncBuildHandle AsyncBuilder::submit(AsyncBuildPriority priority, std::function<void()> run,
+                                      std::function<void()> cancel) {
+  assert(priority < AsyncBuildPriority::Count);
+  AsyncBuildHandle handle = 0;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    handle = m_nextHandle++;
+    m_queues[static_cast<unsigned>(priority)].push_back({handle, std::move(run), std::move(cancel)});
+  }
+  m_jobReady.notify_one();
+  return handle;
+}
+
+// =====================================================================================================================
+// Cancel a queued build. If found, it is removed from its queue and its cancel function is called on this thread.
+//
+// @param handle : Handle of the build
+// @returns : True if the build was cancelled, false if it has already started or completed
+bool AsyncBuilder::cancel(AsyncBuildHandle handle) {
+  Job cancelledJob;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bool found = false;
+    for (auto &queue : m_queues) {
+      for (auto it = queue.begin(); it != queue.end(); ++it) {
+        if (it->handle == handle) {
+          cancelledJob = std::move(*it);
+          queue.erase(it);
+          found = true;
+          break;
+        }
+      }
+      if (found)
+        break;
+    }
+    if (!found)
+      return false;
+  }
+  cancelledJob.cancel();
+  return true;
+}
+
+// =====================================================================================================================
+// Main loop of a compiler thread: run the highest priority queued build until shut down.
+void AsyncBuilder::workerLoop() {
+  for (;;) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      auto findQueue = [this]() -> std::deque<Job> * {
+        for (unsigned priority = static_cast<unsigned>(AsyncBuildPriority::Count); priority-- != 0;) {
+          if (!m_queues[priority].empty())
+            return &m_queues[priority];
+        }
+        return nullptr;
+      };
+      std::deque<Job> *queue = nullptr;
+      m_jobReady.wait(lock, [&]() { return m_shutdown || (queue = findQueue()) != nullptr; });
+      if (!queue)
+        return;
+      job = std::move(queue->front());
+      queue->pop_front();
+    }
+    job.run();
+    // NOTE: If the callback destroyed the compiler, this object has gone.
+    if (BuilderDestroyedOnThisThread)
+      return;
+  }
+}
+
+} // namespace Llpc
@@ -0,0 +1,78 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2020 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcAsyncBuilder.h
+ * @brief LLPC header file: contains declaration of class Llpc::AsyncBuilder.
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "llpc.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Llpc {
+
+// =====================================================================================================================
+// Pool of compiler threads running asynchronous pipeline builds. Queued builds are started in priority order, and
+// in submission order within a priority. A queued build can be cancelled until a thread picks it up.
+class AsyncBuilder {
+public:
+  // A queued build
+  struct Job {
+    AsyncBuildHandle handle;      // Handle given back to the client
+    std::function<void()> run;    // Runs the build and calls the client's callback
+    std::function<void()> cancel; // Calls the client's callback to report cancellation
+  };
+
+  AsyncBuilder(unsigned threadCount);
+  ~AsyncBuilder();
+
+  // Queue a build, returning its handle
+  AsyncBuildHandle submit(AsyncBuildPriority priority, std::function<void()> run, std::function<void()> cancel);
+
+  // Cancel a build that has not started yet
+  bool cancel(AsyncBuildHandle handle);
+
+private:
+  AsyncBuilder(const AsyncBuilder &) = delete;
+  AsyncBuilder &operator=(const AsyncBuilder &) = delete;
+
+  void workerLoop();
+
+  std::mutex m_mutex;                 // Mutex for the queues
+  std::condition_variable m_jobReady; // Signalled when a job is queued or on shutdown
+  std::deque<Job> m_queues[static_cast<unsigned>(AsyncBuildPriority::Count)]; // Per-priority queues of jobs
+  std::vector<std::thread> m_threads; // Compiler threads
+  AsyncBuildHandle m_nextHandle = 1;  // Handle for the next submitted job
+  bool m_shutdown = false;            // Whether threads are being shut down
+};
+
+} // namespace Llpc
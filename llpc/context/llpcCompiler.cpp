@@ -31,6 +31,7 @@
 #include "llpcCompiler.h"
 #include "LLVMSPIRVLib.h"
 #include "SPIRVInternal.h"
+#include "llpcAsyncBuilder.h"
 #include "llpcComputeContext.h"
 #include "llpcContext.h"
 #include "llpcDebug.h"
@@ -175,6 +176,12 @@ static cl::opt<bool> UseBuilderRecorder("use-builder-recorder",
                                         cl::desc("Do lowering via recording and replaying LLPC builder"),
                                         cl::init(true));
 
+// -async-build-threads: number of compiler threads for asynchronous pipeline builds
+static cl::opt<unsigned> AsyncBuildThreads("async-build-threads",
+                                           cl::desc("Number of compiler threads for asynchronous pipeline builds "
+                                                    "(0 - number of hardware threads)"),
+                                           cl::init(0));
+
 namespace Llpc {
 
 sys::Mutex Compiler::m_contextPoolMutex;
@@ -382,6 +389,9 @@ Compiler::Compiler(GfxIpVersion gfxIp, unsigned optionCount, const char *const *
 
 // =====================================================================================================================
 Compiler::~Compiler() {
+  // Cancel queued asynchronous builds and wait for running ones, before anything they use goes away.
+  m_asyncBuilder.reset();
+
   bool shutdown = false;
   {
     // Free context pool
@@ -795,6 +805,16 @@ Result Compiler::buildPipelineWithRelocatableElf(Context *context, ArrayRef<cons
 
   ElfPackage elf[ShaderStageNativeStageCount];
   assert(stageCacheAccesses.size() >= shaderInfo.size());
+
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  // The resource mapping is the same for every stage, so walk it only once for all the stage hashes.
+  std::string resourceMappingHashData =
+      PipelineDumper::getResourceMappingHashData(context->getResourceMapping(), true);
+  const std::string *resourceMappingHashDataPtr = &resourceMappingHashData;
+#else
+  const std::string *resourceMappingHashDataPtr = nullptr;
+#endif
+
   for (unsigned stage = 0; stage < shaderInfo.size() && result == Result::Success; ++stage) {
     if (!shaderInfo[stage] || !shaderInfo[stage]->pModuleData)
       continue;
@@ -807,14 +827,15 @@ Result Compiler::buildPipelineWithRelocatableElf(Context *context, ArrayRef<cons
     ICache *userCache = nullptr;
     if (context->isGraphics()) {
       auto pipelineInfo = reinterpret_cast<const GraphicsPipelineBuildInfo *>(context->getPipelineBuildInfo());
-      cacheHash = PipelineDumper::generateHashForGraphicsPipeline(pipelineInfo, true, true, stage);
+      cacheHash = PipelineDumper::generateHashForGraphicsPipeline(pipelineInfo, true, true, stage,
+                                                                  resourceMappingHashDataPtr);
 #if LLPC_ENABLE_SHADER_CACHE
       userShaderCache = reinterpret_cast<IShaderCache *>(pipelineInfo->pShaderCache);
 #endif
       userCache = pipelineInfo->cache;
     } else {
       auto pipelineInfo = reinterpret_cast<const ComputePipelineBuildInfo *>(context->getPipelineBuildInfo());
-      cacheHash = PipelineDumper::generateHashForComputePipeline(pipelineInfo, true, true);
+      cacheHash = PipelineDumper::generateHashForComputePipeline(pipelineInfo, true, true, resourceMappingHashDataPtr);
 #if LLPC_ENABLE_SHADER_CACHE
       userShaderCache = reinterpret_cast<IShaderCache *>(pipelineInfo->pShaderCache);
 #endif
@@ -1053,6 +1074,23 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
   TimerProfiler timerProfiler(context->getPiplineHashCode(), "LLPC", TimerProfiler::PipelineTimerEnableMask);
   bool buildingRelocatableElf = context->getPipelineContext()->isUnlinked();
 
+  // If the build can be cancelled, the pass managers poll the pipeline context between passes.
+  PipelineContext *pipelineContext = context->getPipelineContext();
+  std::function<bool()> cancelCheck;
+  if (pipelineContext->isCancellable()) {
+    if (pipelineContext->isCancelled())
+      return Result::ErrorCancelled;
+    cancelCheck = [pipelineContext]() { return pipelineContext->isCancelled(); };
+  }
+
+  // The poll between passes only skips optional passes, so also check before starting each pass manager. A build
+  // cancelled between them then returns without running the mandatory passes of the stages that are left.
+  auto checkCancelled = [&cancelCheck, &result]() {
+    if (result == Result::Success && cancelCheck && cancelCheck())
+      result = Result::ErrorCancelled;
+    return result != Result::Success;
+  };
+
   context->setDiagnosticHandler(std::make_unique<LlpcDiagnosticHandler>());
 
   // Set a couple of pipeline options for front-end use.
@@ -1064,6 +1102,7 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
   LgcContext *builderContext = context->getLgcContext();
   std::unique_ptr<Pipeline> pipeline(builderContext->createPipeline());
   context->getPipelineContext()->setPipelineState(&*pipeline, unlinked);
+  pipeline->setCancelCheck(cancelCheck);
   context->setBuilder(builderContext->createBuilder(&*pipeline, UseBuilderRecorder));
 
   std::unique_ptr<Module> pipelineModule;
@@ -1115,7 +1154,15 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
         }
 
         if (binCode.codeSize > 0) {
-          module = context->loadLibary(&binCode).release();
+          // Key the context's lowered module cache on shader module, entry-point name and stage.
+          MetroHash::Hash loweredModuleHash = {};
+          MetroHash64 hasher;
+          hasher.Update(moduleDataEx->common.hash);
+          hasher.Update(entryNameHash);
+          hasher.Update(shaderInfoEntry->entryStage);
+          hasher.Finalize(loweredModuleHash.bytes);
+
+          module = context->loadLoweredModule(&binCode, MetroHash::compact64(&loweredModuleHash)).release();
           stageSkipMask |= (1 << shaderIndex);
         } else
           result = Result::ErrorInvalidShader;
@@ -1139,9 +1186,12 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
         fragmentShaderInfo = shaderInfoEntry;
       if (!shaderInfoEntry || !shaderInfoEntry->pModuleData || (stageSkipMask & shaderStageToMask(entryStage)))
         continue;
+      if (checkCancelled())
+        break;
 
       std::unique_ptr<lgc::PassManager> lowerPassMgr(lgc::PassManager::Create());
       lowerPassMgr->setPassIndex(&passIndex);
+      lowerPassMgr->setCancelCheck(cancelCheck);
 
       // Set the shader stage in the Builder.
       context->getBuilder()->setShaderStage(getLgcShaderStage(entryStage));
@@ -1162,7 +1212,9 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
 
       // Run the passes.
       bool success = runPasses(&*lowerPassMgr, modules[shaderIndex]);
-      if (!success) {
+      if (lowerPassMgr->isCancelled())
+        result = Result::ErrorCancelled;
+      else if (!success) {
         LLPC_ERRS("Failed to translate SPIR-V or run per-shader passes\n");
         result = Result::ErrorInvalidShader;
       }
@@ -1180,16 +1232,21 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
         modulesToLink.push_back(modules[shaderIndex]);
         continue;
       }
+      if (checkCancelled())
+        break;
 
       context->getBuilder()->setShaderStage(getLgcShaderStage(entryStage));
       std::unique_ptr<lgc::PassManager> lowerPassMgr(lgc::PassManager::Create());
       lowerPassMgr->setPassIndex(&passIndex);
+      lowerPassMgr->setCancelCheck(cancelCheck);
 
       SpirvLower::addPasses(context, entryStage, *lowerPassMgr, timerProfiler.getTimer(TimerLower)
       );
       // Run the passes.
       bool success = runPasses(&*lowerPassMgr, modules[shaderIndex]);
-      if (!success) {
+      if (lowerPassMgr->isCancelled())
+        result = Result::ErrorCancelled;
+      else if (!success) {
         LLPC_ERRS("Failed to translate SPIR-V or run per-shader passes\n");
         result = Result::ErrorInvalidShader;
       }
@@ -1215,7 +1272,7 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
           ArrayRef<ArrayRef<uint8_t>> stageHashes //
                                                   // @param module : Module
                                                   // @param stageMask : Shader stage mask
-                                                  // @param stageHashes : Per-stage hash of in/out usage
+                                                  // @param stageHashes : Per-stage inter-shader data hash
       ) { return graphicsShaderCacheChecker.check(module, stageMask, stageHashes); };
 
   // Only enable per stage cache for full graphic pipeline
@@ -1228,7 +1285,7 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
   // Generate pipeline.
   raw_svector_ostream elfStream(*pipelineElf);
 
-  if (result == Result::Success) {
+  if (!checkCancelled()) {
     result = Result::ErrorInvalidShader;
 #if LLPC_ENABLE_EXCEPTION
     try
@@ -1240,8 +1297,14 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
           timerProfiler.getTimer(TimerCodeGen),
       };
 
-      pipeline->generate(std::move(pipelineModule), elfStream, checkShaderCacheFunc, timers, {});
-      result = Result::Success;
+      if (pipeline->generate(std::move(pipelineModule), elfStream, checkShaderCacheFunc, timers, {}))
+        result = Result::Success;
+      else if (pipeline->wasCancelled())
+        result = Result::ErrorCancelled;
+      else {
+        LLPC_ERRS("Failed to generate pipeline: " << pipeline->getLastError() << "\n");
+        result = Result::ErrorUnknown;
+      }
     }
 #if LLPC_ENABLE_EXCEPTION
     catch (const char *) {
@@ -1269,7 +1332,7 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
 //
 // @param module : Module
 // @param stageMask : Shader stage mask
-// @param stageHashes : Per-stage hash of in/out usage
+// @param stageHashes : Per-stage inter-shader data hash
 unsigned GraphicsShaderCacheChecker::check(const Module *module, unsigned stageMask,
                                            ArrayRef<ArrayRef<uint8_t>> stageHashes) {
   // Check per stage shader cache
@@ -1487,10 +1550,20 @@ Result Compiler::BuildGraphicsPipeline(const GraphicsPipelineBuildInfo *pipeline
   for (unsigned i = 0; i < ShaderStageGfxCount && result == Result::Success; ++i)
     result = validatePipelineShaderInfo(shaderInfo[i]);
 
+  // Both hashes include the same resource mapping data, so walk the resource mapping only once.
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  std::string resourceMappingHashData =
+      PipelineDumper::getResourceMappingHashData(&pipelineInfo->resourceMapping, false);
+  const std::string *resourceMappingHashDataPtr = &resourceMappingHashData;
+#else
+  const std::string *resourceMappingHashDataPtr = nullptr;
+#endif
   MetroHash::Hash cacheHash = {};
   MetroHash::Hash pipelineHash = {};
-  cacheHash = PipelineDumper::generateHashForGraphicsPipeline(pipelineInfo, true, false);
-  pipelineHash = PipelineDumper::generateHashForGraphicsPipeline(pipelineInfo, false, false);
+  cacheHash = PipelineDumper::generateHashForGraphicsPipeline(pipelineInfo, true, false, ShaderStageInvalid,
+                                                              resourceMappingHashDataPtr);
+  pipelineHash = PipelineDumper::generateHashForGraphicsPipeline(pipelineInfo, false, false, ShaderStageInvalid,
+                                                                 resourceMappingHashDataPtr);
 
   if (result == Result::Success && EnableOuts()) {
     LLPC_OUTS("===============================================================================\n");
@@ -1630,10 +1703,20 @@ Result Compiler::BuildComputePipeline(const ComputePipelineBuildInfo *pipelineIn
 
   Result result = validatePipelineShaderInfo(&pipelineInfo->cs);
 
+  // Both hashes include the same resource mapping data, so walk the resource mapping only once.
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  std::string resourceMappingHashData =
+      PipelineDumper::getResourceMappingHashData(&pipelineInfo->resourceMapping, buildingRelocatableElf);
+  const std::string *resourceMappingHashDataPtr = &resourceMappingHashData;
+#else
+  const std::string *resourceMappingHashDataPtr = nullptr;
+#endif
   MetroHash::Hash cacheHash = {};
   MetroHash::Hash pipelineHash = {};
-  cacheHash = PipelineDumper::generateHashForComputePipeline(pipelineInfo, true, buildingRelocatableElf);
-  pipelineHash = PipelineDumper::generateHashForComputePipeline(pipelineInfo, false, buildingRelocatableElf);
+  cacheHash = PipelineDumper::generateHashForComputePipeline(pipelineInfo, true, buildingRelocatableElf,
+                                                             resourceMappingHashDataPtr);
+  pipelineHash = PipelineDumper::generateHashForComputePipeline(pipelineInfo, false, buildingRelocatableElf,
+                                                                resourceMappingHashDataPtr);
 
   if (result == Result::Success && EnableOuts()) {
     const ShaderModuleData *moduleData = reinterpret_cast<const ShaderModuleData *>(pipelineInfo->cs.pModuleData);
@@ -1726,6 +1809,141 @@ Result Compiler::BuildComputePipeline(const ComputePipelineBuildInfo *pipelineIn
   return result;
 }
 
+// =====================================================================================================================
+// Gets the thread pool for asynchronous pipeline builds, creating it on first use.
+AsyncBuilder *Compiler::getAsyncBuilder() {
+  std::lock_guard<std::mutex> lock(m_asyncBuilderMutex);
+  if (!m_asyncBuilder)
+    m_asyncBuilder.reset(new AsyncBuilder(AsyncBuildThreads));
+  return m_asyncBuilder.get();
+}
+
+// =====================================================================================================================
+// Queues an asynchronous build of a graphics pipeline.
+//
+// @param pipelineInfo : Info to build this graphics pipeline
+// @param priority : Priority of the build
+// @param pfnCallback : Function to call with the result of the build
+// @param callbackData : Client data passed to the callback
+// @param [out] handle : Handle of the queued build (optional)
+Result Compiler::BuildGraphicsPipelineAsync(const GraphicsPipelineBuildInfo *pipelineInfo, AsyncBuildPriority priority,
+                                            GraphicsPipelineBuildCallback pfnCallback, void *callbackData,
+                                            AsyncBuildHandle *handle) {
+  if (!pipelineInfo || !pfnCallback)
+    return Result::ErrorInvalidPointer;
+
+  // The build info itself is copied, but what it points to stays owned by the client until the callback.
+  GraphicsPipelineBuildInfo info = *pipelineInfo;
+  auto run = [this, info, pfnCallback, callbackData]() {
+    GraphicsPipelineBuildOut pipelineOut = {};
+    Result result = BuildGraphicsPipeline(&info, &pipelineOut, nullptr);
+    pfnCallback(callbackData, result, &pipelineOut);
+  };
+  auto cancel = [pfnCallback, callbackData]() { pfnCallback(callbackData, Result::ErrorCancelled, nullptr); };
+
+  AsyncBuildHandle newHandle = getAsyncBuilder()->submit(priority, run, cancel);
+  if (handle)
+    *handle = newHandle;
+  return Result::Success;
+}
+
+// =====================================================================================================================
+// Queues an asynchronous build of a compute pipeline.
+//
+// @param pipelineInfo : Info to build this compute pipeline
+// @param priority : Priority of the build
+// @param pfnCallback : Function to call with the result of the build
+// @param callbackData : Client data passed to the callback
+// @param [out] handle : Handle of the queued build (optional)
+Result Compiler::BuildComputePipelineAsync(const ComputePipelineBuildInfo *pipelineInfo, AsyncBuildPriority priority,
+                                           ComputePipelineBuildCallback pfnCallback, void *callbackData,
+                                           AsyncBuildHandle *handle) {
+  if (!pipelineInfo || !pfnCallback)
+    return Result::ErrorInvalidPointer;
+
+  ComputePipelineBuildInfo info = *pipelineInfo;
+  auto run = [this, info, pfnCallback, callbackData]() {
+    ComputePipelineBuildOut pipelineOut = {};
+    Result result = BuildComputePipeline(&info, &pipelineOut, nullptr);
+    pfnCallback(callbackData, result, &pipelineOut);
+  };
+  auto cancel = [pfnCallback, callbackData]() { pfnCallback(callbackData, Result::ErrorCancelled, nullptr); };
+
+  AsyncBuildHandle newHandle = getAsyncBuilder()->submit(priority, run, cancel);
+  if (handle)
+    *handle = newHandle;
+  return Result::Success;
+}
+
+// =====================================================================================================================
+// Cancels an asynchronous build that has not started yet.
+//
+// @param handle : Handle of the build
+Result Compiler::CancelAsyncBuild(AsyncBuildHandle handle) {
+  AsyncBuilder *asyncBuilder = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(m_asyncBuilderMutex);
+    asyncBuilder = m_asyncBuilder.get();
+  }
+  if (!asyncBuilder || !asyncBuilder->cancel(handle))
+    return Result::NotFound;
+  return Result::Success;
+}
+
+// =====================================================================================================================
+// Builds a graphics pipeline in two tiers: a fast compile now, and the optimized build queued asynchronously.
+//
+// @param pipelineInfo : Info to build this graphics pipeline
+// @param [out] pipelineOut : Output of the fast build of this graphics pipeline
+// @param priority : Priority of the optimized build
+// @param pfnCallback : Function to call with the result of the optimized build
+// @param callbackData : Client data passed to the callback
+// @param [out] handle : Handle of the queued optimized build (optional)
+Result Compiler::BuildGraphicsPipelineTiered(const GraphicsPipelineBuildInfo *pipelineInfo,
+                                             GraphicsPipelineBuildOut *pipelineOut, AsyncBuildPriority priority,
+                                             GraphicsPipelineBuildCallback pfnCallback, void *callbackData,
+                                             AsyncBuildHandle *handle) {
+  if (!pipelineInfo || !pipelineOut || !pfnCallback)
+    return Result::ErrorInvalidPointer;
+
+  // The fast build has its own cache hash (fastCompile is hashed), so it never replaces the optimized pipeline in
+  // the cache.
+  GraphicsPipelineBuildInfo tierInfo = *pipelineInfo;
+  tierInfo.options.fastCompile = true;
+  Result result = BuildGraphicsPipeline(&tierInfo, pipelineOut, nullptr);
+  if (result != Result::Success)
+    return result;
+
+  tierInfo.options.fastCompile = false;
+  return BuildGraphicsPipelineAsync(&tierInfo, priority, pfnCallback, callbackData, handle);
+}
+
+// =====================================================================================================================
+// Builds a compute pipeline in two tiers: a fast compile now, and the optimized build queued asynchronously.
+//
+// @param pipelineInfo : Info to build this compute pipeline
+// @param [out] pipelineOut : Output of the fast build of this compute pipeline
+// @param priority : Priority of the optimized build
+// @param pfnCallback : Function to call with the result of the optimized build
+// @param callbackData : Client data passed to the callback
+// @param [out] handle : Handle of the queued optimized build (optional)
+Result Compiler::BuildComputePipelineTiered(const ComputePipelineBuildInfo *pipelineInfo,
+                                            ComputePipelineBuildOut *pipelineOut, AsyncBuildPriority priority,
+                                            ComputePipelineBuildCallback pfnCallback, void *callbackData,
+                                            AsyncBuildHandle *handle) {
+  if (!pipelineInfo || !pipelineOut || !pfnCallback)
+    return Result::ErrorInvalidPointer;
+
+  ComputePipelineBuildInfo tierInfo = *pipelineInfo;
+  tierInfo.options.fastCompile = true;
+  Result result = BuildComputePipeline(&tierInfo, pipelineOut, nullptr);
+  if (result != Result::Success)
+    return result;
+
+  tierInfo.options.fastCompile = false;
+  return BuildComputePipelineAsync(&tierInfo, priority, pfnCallback, callbackData, handle);
+}
+
 // =====================================================================================================================
 // Builds hash code from compilation-options
 //
@@ -1742,6 +1960,7 @@ MetroHash::Hash Compiler::generateHashForCompileOptions(unsigned optionCount, co
                                        cl::LogFileDbgs.ArgStr,
                                        cl::LogFileOuts.ArgStr,
                                        cl::ExecutableName.ArgStr,
+                                       "async-build-threads",
                                        "unlinked",
                                        "o"};
 
@@ -2064,7 +2283,7 @@ void Compiler::ReleaseCacheEntry(bool withValue, const BinaryData *elfBin, Entry
 //
 // @param context : Acquired context
 // @param stageMask : Shader stage mask
-// @param stageHashes : Per-stage hash of in/out usage
+// @param stageHashes : Per-stage inter-shader data hash
 // @param [out] fragmentHash : Hash code of fragment shader
 // @param [out] nonFragmentHash : Hash code of all non-fragment shader
 void Compiler::buildShaderCacheHash(Context *context, unsigned stageMask, ArrayRef<ArrayRef<uint8_t>> stageHashes,
@@ -2074,6 +2293,12 @@ void Compiler::buildShaderCacheHash(Context *context, unsigned stageMask, ArrayR
   auto pipelineInfo = reinterpret_cast<const GraphicsPipelineBuildInfo *>(context->getPipelineBuildInfo());
   auto pipelineOptions = context->getPipelineContext()->getPipelineOptions();
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  // The resource mapping is the same for every stage, so walk it only once.
+  std::string resourceMappingHashData =
+      PipelineDumper::getResourceMappingHashData(context->getResourceMapping(), false);
+#endif
+
   // Build hash per shader stage
   for (auto stage = ShaderStageVertex; stage < ShaderStageGfxCount; stage = static_cast<ShaderStage>(stage + 1)) {
     if ((stageMask & shaderStageToMask(stage)) == 0)
@@ -2087,10 +2312,10 @@ void Compiler::buildShaderCacheHash(Context *context, unsigned stageMask, ArrayR
     hasher.Update(pipelineInfo->iaState.deviceIndex);
 
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
-    PipelineDumper::updateHashForResourceMappingInfo(context->getResourceMapping(), &hasher, false);
+    hasher.Update(reinterpret_cast<const uint8_t *>(resourceMappingHashData.data()), resourceMappingHashData.size());
 #endif
 
-    // Update input/output usage (provided by middle-end caller of this callback).
+    // Update the hash of inter-shader data used to compile this stage (provided by middle-end caller of this callback).
     hasher.Update(stageHashes[stage].data(), stageHashes[stage].size());
 
     // Update vertex input state
@@ -2119,7 +2344,7 @@ void Compiler::buildShaderCacheHash(Context *context, unsigned stageMask, ArrayR
     fragmentHasher.Update(pipelineOptions->extendedRobustness.robustBufferAccess);
     fragmentHasher.Update(pipelineOptions->extendedRobustness.robustImageAccess);
     fragmentHasher.Update(pipelineOptions->extendedRobustness.nullDescriptor);
-    PipelineDumper::updateHashForFragmentState(pipelineInfo, &fragmentHasher, false);
+    PipelineDumper::updateHashForFragmentState(pipelineInfo, true, &fragmentHasher, false);
     fragmentHasher.Finalize(fragmentHash->bytes);
   }
 
@@ -36,6 +36,8 @@
 #include "vkgcElfReader.h"
 #include "vkgcMetroHash.h"
 #include "lgc/CommonDefs.h"
+#include <memory>
+#include <mutex>
 
 namespace llvm {
 
@@ -55,6 +57,7 @@ using Vkgc::ElfPackage;
 using Vkgc::findVkStructInChain;
 
 // Forward declaration
+class AsyncBuilder;
 class Compiler;
 class ComputeContext;
 class Context;
@@ -120,6 +123,27 @@ public:
 
   virtual Result BuildComputePipeline(const ComputePipelineBuildInfo *pipelineInfo,
                                       ComputePipelineBuildOut *pipelineOut, void *pipelineDumpFile = nullptr);
+
+  virtual Result BuildGraphicsPipelineAsync(const GraphicsPipelineBuildInfo *pipelineInfo, AsyncBuildPriority priority,
+                                            GraphicsPipelineBuildCallback pfnCallback, void *callbackData,
+                                            AsyncBuildHandle *handle = nullptr);
+
+  virtual Result BuildComputePipelineAsync(const ComputePipelineBuildInfo *pipelineInfo, AsyncBuildPriority priority,
+                                           ComputePipelineBuildCallback pfnCallback, void *callbackData,
+                                           AsyncBuildHandle *handle = nullptr);
+
+  virtual Result CancelAsyncBuild(AsyncBuildHandle handle);
+
+  virtual Result BuildGraphicsPipelineTiered(const GraphicsPipelineBuildInfo *pipelineInfo,
+                                             GraphicsPipelineBuildOut *pipelineOut, AsyncBuildPriority priority,
+                                             GraphicsPipelineBuildCallback pfnCallback, void *callbackData,
+                                             AsyncBuildHandle *handle = nullptr);
+
+  virtual Result BuildComputePipelineTiered(const ComputePipelineBuildInfo *pipelineInfo,
+                                            ComputePipelineBuildOut *pipelineOut, AsyncBuildPriority priority,
+                                            ComputePipelineBuildCallback pfnCallback, void *callbackData,
+                                            AsyncBuildHandle *handle = nullptr);
+
   Result buildGraphicsPipelineInternal(GraphicsContext *graphicsContext,
                                        llvm::ArrayRef<const PipelineShaderInfo *> shaderInfo,
                                        bool buildingRelocatableElf, ElfPackage *pipelineElf,
@@ -179,6 +203,7 @@ private:
   bool canUseRelocatableGraphicsShaderElf(const llvm::ArrayRef<const PipelineShaderInfo *> &shaderInfo,
                                           const GraphicsPipelineBuildInfo *pipelineInfo);
   bool canUseRelocatableComputeShaderElf(const ComputePipelineBuildInfo *pipelineInfo);
+  AsyncBuilder *getAsyncBuilder();
 
   std::vector<std::string> m_options;           // Compilation options
   MetroHash::Hash m_optionHash;                 // Hash code of compilation options
@@ -190,6 +215,8 @@ private:
   static llvm::sys::Mutex m_contextPoolMutex;   // Mutex for context pool access
   static std::vector<Context *> *m_contextPool; // Context pool
   unsigned m_relocatablePipelineCompilations;   // The number of pipelines compiled using relocatable shader elf
+  std::mutex m_asyncBuilderMutex;               // Mutex for lazy creation of the async builder
+  std::unique_ptr<AsyncBuilder> m_asyncBuilder; // Thread pool for asynchronous pipeline builds
 };
 
 // Convert front-end LLPC shader stage to middle-end LGC shader stage
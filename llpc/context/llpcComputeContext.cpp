@@ -48,6 +48,7 @@ ComputeContext::ComputeContext(GfxIpVersion gfxIp, const ComputePipelineBuildInf
                                MetroHash::Hash *pipelineHash, MetroHash::Hash *cacheHash)
     : PipelineContext(gfxIp, pipelineHash, cacheHash), m_pipelineInfo(pipelineInfo) {
   setUnlinked(pipelineInfo->unlinked);
+  setCancelCondition(pipelineInfo->pCancelFlag, pipelineInfo->timeLimitMs);
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
   m_resourceMapping = pipelineInfo->resourceMapping;
 #else
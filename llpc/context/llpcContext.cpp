@@ -56,6 +56,12 @@
 using namespace lgc;
 using namespace llvm;
 
+// -lowered-module-cache-size: per-context limit on cached lowered shader modules
+static cl::opt<unsigned> LoweredModuleCacheSize(
+    "lowered-module-cache-size",
+    cl::desc("Maximum total bitcode size (in KB) of lowered shader modules cached in each context, 0 to disable"),
+    cl::init(4096));
+
 namespace Llpc {
 
 // =====================================================================================================================
@@ -115,6 +121,52 @@ std::unique_ptr<Module> Context::loadLibary(const BinaryData *lib) {
   return libModule;
 }
 
+// =====================================================================================================================
+// Loads a lowered shader module (an entry of a MultiLlvmBc shader module). The materialized module is kept in a
+// size-bounded LRU cache in this context, so a shader module shared by many pipelines is deserialized only once;
+// each caller gets its own clone.
+//
+// @param lib : Bitcode of the lowered shader module
+// @param cacheKey : Key identifying the lowered module, hashed from shader module hash, entry-point name and stage
+std::unique_ptr<Module> Context::loadLoweredModule(const BinaryData *lib, uint64_t cacheKey) {
+  const size_t cacheLimit = static_cast<size_t>(LoweredModuleCacheSize) * 1024;
+  if (lib->codeSize > cacheLimit)
+    return loadLibary(lib);
+
+  auto mapIt = m_loweredModuleCacheMap.find(cacheKey);
+  if (mapIt != m_loweredModuleCacheMap.end()) {
+    auto entryIt = mapIt->second;
+    if (entryIt->bitcodeSize == lib->codeSize) {
+      // Cache hit: make it the most recently used entry, and hand out a clone.
+      m_loweredModuleCache.splice(m_loweredModuleCache.begin(), m_loweredModuleCache, entryIt);
+      return CloneModule(*entryIt->module);
+    }
+
+    // Same key but different bitcode: drop the stale entry.
+    m_loweredModuleCacheSize -= entryIt->bitcodeSize;
+    m_loweredModuleCache.erase(entryIt);
+    m_loweredModuleCacheMap.erase(mapIt);
+  }
+
+  std::unique_ptr<Module> libModule = loadLibary(lib);
+  if (!libModule)
+    return nullptr;
+
+  // Evict least recently used entries to make room.
+  while (!m_loweredModuleCache.empty() && m_loweredModuleCacheSize + lib->codeSize > cacheLimit) {
+    LoweredModuleCacheEntry &lruEntry = m_loweredModuleCache.back();
+    m_loweredModuleCacheSize -= lruEntry.bitcodeSize;
+    m_loweredModuleCacheMap.erase(lruEntry.key);
+    m_loweredModuleCache.pop_back();
+  }
+
+  std::unique_ptr<Module> clonedModule = CloneModule(*libModule);
+  m_loweredModuleCache.push_front({cacheKey, lib->codeSize, std::move(libModule)});
+  m_loweredModuleCacheMap[cacheKey] = m_loweredModuleCache.begin();
+  m_loweredModuleCacheSize += lib->codeSize;
+  return clonedModule;
+}
+
 // =====================================================================================================================
 // Sets triple and data layout in specified module from the context's target machine.
 //
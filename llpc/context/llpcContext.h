@@ -37,6 +37,7 @@
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Type.h"
 #include "llvm/Target/TargetMachine.h"
+#include <list>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -103,6 +104,9 @@ public:
 
   std::unique_ptr<llvm::Module> loadLibary(const BinaryData *lib);
 
+  // Loads a lowered shader module, through the cache of materialized lowered modules in this context.
+  std::unique_ptr<llvm::Module> loadLoweredModule(const BinaryData *lib, uint64_t cacheKey);
+
   // Wrappers of interfaces of pipeline context
   bool isGraphics() const { return m_pipelineContext->isGraphics(); }
   const PipelineShaderInfo *getPipelineShaderInfo(ShaderStage shaderStage) const {
@@ -148,6 +152,18 @@ private:
   bool m_robustBufferAccess = false;                    // robustBufferAccess option from last pipeline compile
 
   unsigned m_useCount = 0; // Number of times this context is used.
+
+  // Entry in the cache of materialized lowered shader modules
+  struct LoweredModuleCacheEntry {
+    uint64_t key;                         // Hash of shader module, entry-point name and stage
+    size_t bitcodeSize;                   // Size of the bitcode the module was loaded from
+    std::unique_ptr<llvm::Module> module; // Materialized module, cloned for each user
+  };
+  typedef std::list<LoweredModuleCacheEntry> LoweredModuleCacheList;
+
+  LoweredModuleCacheList m_loweredModuleCache; // Cached lowered modules, most recently used first
+  std::unordered_map<uint64_t, LoweredModuleCacheList::iterator> m_loweredModuleCacheMap; // Map key -> cache entry
+  size_t m_loweredModuleCacheSize = 0; // Total bitcode size of cached lowered modules
 };
 
 } // namespace Llpc
@@ -52,6 +52,7 @@ GraphicsContext::GraphicsContext(GfxIpVersion gfxIp, const GraphicsPipelineBuild
     : PipelineContext(gfxIp, pipelineHash, cacheHash), m_pipelineInfo(pipelineInfo), m_stageMask(0),
       m_activeStageCount(0), m_gsOnChip(false) {
   setUnlinked(pipelineInfo->unlinked);
+  setCancelCondition(pipelineInfo->pCancelFlag, pipelineInfo->timeLimitMs);
   const PipelineShaderInfo *shaderInfo[ShaderStageGfxCount] = {
       &pipelineInfo->vs, &pipelineInfo->tcs, &pipelineInfo->tes, &pipelineInfo->gs, &pipelineInfo->fs,
   };
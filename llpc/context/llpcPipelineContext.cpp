@@ -137,6 +137,30 @@ PipelineContext::PipelineContext(GfxIpVersion gfxIp, MetroHash::Hash *pipelineHa
 PipelineContext::~PipelineContext() {
 }
 
+// =====================================================================================================================
+// Set the client's cancel flag and time limit for the build. The time limit counts from now.
+//
+// @param cancelFlag : Client's flag to cancel the build, or nullptr
+// @param timeLimitMs : Time limit in milliseconds, or 0 for none
+void PipelineContext::setCancelCondition(const std::atomic<bool> *cancelFlag, unsigned timeLimitMs) {
+  m_cancelFlag = cancelFlag;
+  m_hasDeadline = timeLimitMs != 0;
+  if (m_hasDeadline)
+    m_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeLimitMs);
+}
+
+// =====================================================================================================================
+// Check whether the client has cancelled the build, or its time limit has passed. Once this has returned true, it
+// keeps returning true, so the build cannot be half-cancelled.
+bool PipelineContext::isCancelled() const {
+  if (!m_cancelled) {
+    // The flag is only a request to stop, and does not publish any other data, so relaxed ordering is enough.
+    m_cancelled = (m_cancelFlag && m_cancelFlag->load(std::memory_order_relaxed)) ||
+                  (m_hasDeadline && std::chrono::steady_clock::now() >= m_deadline);
+  }
+  return m_cancelled;
+}
+
 // =====================================================================================================================
 // Gets the name string of GPU target according to graphics IP version info.
 //
@@ -333,6 +357,7 @@ void PipelineContext::setOptionsInPipeline(Pipeline *pipeline) const {
 
   options.allowNullDescriptor = getPipelineOptions()->extendedRobustness.nullDescriptor;
   options.disableImageResourceCheck = getPipelineOptions()->disableImageResourceCheck;
+  options.fastCompile = getPipelineOptions()->fastCompile;
 
   pipeline->setOptions(options);
 
@@ -427,6 +452,21 @@ void PipelineContext::setOptionsInPipeline(Pipeline *pipeline) const {
         shaderOptions.dontUnrollHintThreshold = shaderInfo->options.dontUnrollHintThreshold;
       else
         shaderOptions.dontUnrollHintThreshold = DontUnrollHintThreshold;
+
+      static_assert(static_cast<lgc::WorkgroupIdSwizzle>(Vkgc::WorkgroupIdSwizzle::None) ==
+                        lgc::WorkgroupIdSwizzle::None,
+                    "Mismatch");
+      static_assert(static_cast<lgc::WorkgroupIdSwizzle>(Vkgc::WorkgroupIdSwizzle::Tiled) ==
+                        lgc::WorkgroupIdSwizzle::Tiled,
+                    "Mismatch");
+      static_assert(static_cast<lgc::WorkgroupIdSwizzle>(Vkgc::WorkgroupIdSwizzle::Morton) ==
+                        lgc::WorkgroupIdSwizzle::Morton,
+                    "Mismatch");
+      static_assert(static_cast<lgc::WorkgroupIdSwizzle>(Vkgc::WorkgroupIdSwizzle::ColumnStrips) ==
+                        lgc::WorkgroupIdSwizzle::ColumnStrips,
+                    "Mismatch");
+      shaderOptions.workgroupIdSwizzle = static_cast<lgc::WorkgroupIdSwizzle>(shaderInfo->options.workgroupIdSwizzle);
+      shaderOptions.workgroupIdSwizzleSize = shaderInfo->options.workgroupIdSwizzleSize;
       pipeline->setShaderOptions(getLgcShaderStage(static_cast<ShaderStage>(stage)), shaderOptions);
     }
   }
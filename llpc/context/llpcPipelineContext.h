@@ -38,6 +38,8 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Type.h"
+#include <atomic>
+#include <chrono>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -147,7 +149,16 @@ public:
   // Gets pipeline resource mapping data
   const ResourceMappingData *getResourceMapping() const { return &m_resourceMapping; }
 
+  // Check whether the client has cancelled the build, or its time limit has passed
+  bool isCancelled() const;
+
+  // Get whether the build can be cancelled at all
+  bool isCancellable() const { return m_cancelFlag || m_hasDeadline; }
+
 protected:
+  // Set the client's cancel flag and time limit for the build
+  void setCancelCondition(const std::atomic<bool> *cancelFlag, unsigned timeLimitMs);
+
   // Gets dummy vertex input create info
   virtual VkPipelineVertexInputStateCreateInfo *getDummyVertexInputInfo() { return nullptr; }
 
@@ -194,7 +205,11 @@ private:
   void setColorExportState(lgc::Pipeline *pipeline) const;
 
   ShaderFpMode m_shaderFpModes[ShaderStageCountInternal] = {};
-  bool m_unlinked = false; // Whether we are building an "unlinked" half-pipeline ELF
+  bool m_unlinked = false;                          // Whether we are building an "unlinked" half-pipeline ELF
+  const std::atomic<bool> *m_cancelFlag = nullptr;  // Client's flag to cancel the build
+  bool m_hasDeadline = false;                       // Whether the build has a time limit
+  std::chrono::steady_clock::time_point m_deadline; // Time at which the build is abandoned
+  mutable bool m_cancelled = false;                 // Whether the build has been found to be cancelled
 };
 
 } // namespace Llpc
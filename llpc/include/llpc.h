@@ -129,6 +129,27 @@ struct ComputePipelineBuildOut {
   CacheAccessInfo stageCacheAccess;    ///< Shader cache access status i.e., hit, miss, or not checked
 };
 
+/// Enumerates priorities of asynchronous pipeline builds. Queued builds of higher priority are started first.
+enum class AsyncBuildPriority : unsigned {
+  Background = 0, ///< Background build, such as pre-warming a pipeline cache
+  Normal,         ///< Default priority
+  Interactive,    ///< Build that the application is waiting on
+  Count,
+};
+
+/// Handle of an asynchronous pipeline build. 0 is never a valid handle.
+typedef uint64_t AsyncBuildHandle;
+
+/// Defines callback function called when an asynchronous graphics pipeline build completes or is cancelled.
+/// The result is Result::ErrorCancelled if the build was cancelled, in which case pPipelineOut is null.
+typedef void (*GraphicsPipelineBuildCallback)(void *pCallbackData, Result result,
+                                              const GraphicsPipelineBuildOut *pPipelineOut);
+
+/// Defines callback function called when an asynchronous compute pipeline build completes or is cancelled.
+/// The result is Result::ErrorCancelled if the build was cancelled, in which case pPipelineOut is null.
+typedef void (*ComputePipelineBuildCallback)(void *pCallbackData, Result result,
+                                             const ComputePipelineBuildOut *pPipelineOut);
+
 /// Defines callback function used to lookup shader cache info in an external cache
 typedef Result (*ShaderCacheGetValue)(const void *pClientData, uint64_t hash, void *pValue, size_t *pValueLen);
 
@@ -251,6 +272,82 @@ public:
   virtual Result BuildComputePipeline(const ComputePipelineBuildInfo *pPipelineInfo,
                                       ComputePipelineBuildOut *pPipelineOut, void *pPipelineDumpFile = nullptr) = 0;
 
+  /// Queues an asynchronous build of a graphics pipeline on the compiler's internal pool of compiler threads.
+  ///
+  /// The build info, and everything it points to, must remain valid until the callback has been called. The callback
+  /// is called exactly once: on a compiler thread when the build completes, or on the thread calling
+  /// CancelAsyncBuild() or Destroy() if the build is cancelled before it starts. The callback may call Destroy(); the
+  /// compiler is then destroyed once the other compiler threads have finished their builds, and the compiler thread
+  /// running the callback exits when the callback returns.
+  ///
+  /// @param [in]  pPipelineInfo  Info to build this graphics pipeline
+  /// @param [in]  priority       Priority of the build
+  /// @param [in]  pfnCallback    Function to call with the result of the build
+  /// @param [in]  pCallbackData  Client data passed to the callback
+  /// @param [out] pHandle : Handle of the queued build, for use with CancelAsyncBuild (optional)
+  ///
+  /// @returns : Result::Success if the build was queued. Other return codes indicate failure.
+  virtual Result BuildGraphicsPipelineAsync(const GraphicsPipelineBuildInfo *pPipelineInfo,
+                                            AsyncBuildPriority priority, GraphicsPipelineBuildCallback pfnCallback,
+                                            void *pCallbackData, AsyncBuildHandle *pHandle = nullptr) = 0;
+
+  /// Queues an asynchronous build of a compute pipeline on the compiler's internal pool of compiler threads.
+  /// The same rules apply as for BuildGraphicsPipelineAsync.
+  ///
+  /// @param [in]  pPipelineInfo  Info to build this compute pipeline
+  /// @param [in]  priority       Priority of the build
+  /// @param [in]  pfnCallback    Function to call with the result of the build
+  /// @param [in]  pCallbackData  Client data passed to the callback
+  /// @param [out] pHandle : Handle of the queued build, for use with CancelAsyncBuild (optional)
+  ///
+  /// @returns : Result::Success if the build was queued. Other return codes indicate failure.
+  virtual Result BuildComputePipelineAsync(const ComputePipelineBuildInfo *pPipelineInfo, AsyncBuildPriority priority,
+                                           ComputePipelineBuildCallback pfnCallback, void *pCallbackData,
+                                           AsyncBuildHandle *pHandle = nullptr) = 0;
+
+  /// Builds a graphics pipeline in two tiers. A fast compile (see PipelineOptions::fastCompile) is done immediately and
+  /// returned in pPipelineOut, so the application has a valid pipeline to use straight away. The fully optimized
+  /// build is then queued as an asynchronous build (see BuildGraphicsPipelineAsync); when it completes, it has been
+  /// stored in the pipeline cache and is passed to the callback, and the client can switch over to it.
+  ///
+  /// @param [in]  pPipelineInfo  Info to build this graphics pipeline
+  /// @param [out] pPipelineOut : Output of the fast build of this graphics pipeline
+  /// @param [in]  priority       Priority of the optimized build
+  /// @param [in]  pfnCallback    Function to call with the result of the optimized build
+  /// @param [in]  pCallbackData  Client data passed to the callback
+  /// @param [out] pHandle : Handle of the queued optimized build, for use with CancelAsyncBuild (optional)
+  ///
+  /// @returns : Result::Success if the fast build succeeded and the optimized build was queued. Other return codes
+  ///            indicate failure, in which case the optimized build is not queued.
+  virtual Result BuildGraphicsPipelineTiered(const GraphicsPipelineBuildInfo *pPipelineInfo,
+                                             GraphicsPipelineBuildOut *pPipelineOut, AsyncBuildPriority priority,
+                                             GraphicsPipelineBuildCallback pfnCallback, void *pCallbackData,
+                                             AsyncBuildHandle *pHandle = nullptr) = 0;
+
+  /// Builds a compute pipeline in two tiers. The same rules apply as for BuildGraphicsPipelineTiered.
+  ///
+  /// @param [in]  pPipelineInfo  Info to build this compute pipeline
+  /// @param [out] pPipelineOut : Output of the fast build of this compute pipeline
+  /// @param [in]  priority       Priority of the optimized build
+  /// @param [in]  pfnCallback    Function to call with the result of the optimized build
+  /// @param [in]  pCallbackData  Client data passed to the callback
+  /// @param [out] pHandle : Handle of the queued optimized build, for use with CancelAsyncBuild (optional)
+  ///
+  /// @returns : Result::Success if the fast build succeeded and the optimized build was queued. Other return codes
+  ///            indicate failure, in which case the optimized build is not queued.
+  virtual Result BuildComputePipelineTiered(const ComputePipelineBuildInfo *pPipelineInfo,
+                                            ComputePipelineBuildOut *pPipelineOut, AsyncBuildPriority priority,
+                                            ComputePipelineBuildCallback pfnCallback, void *pCallbackData,
+                                            AsyncBuildHandle *pHandle = nullptr) = 0;
+
+  /// Cancels an asynchronous build that has not started yet. Its callback is called with Result::ErrorCancelled
+  /// before this returns.
+  ///
+  /// @param [in]  handle         Handle of the build
+  ///
+  /// @returns : Result::Success if the build was cancelled, Result::NotFound if it has already started or completed.
+  virtual Result CancelAsyncBuild(AsyncBuildHandle handle) = 0;
+
 #if LLPC_ENABLE_SHADER_CACHE
   /// Creates a shader cache object with the requested properties.
   ///
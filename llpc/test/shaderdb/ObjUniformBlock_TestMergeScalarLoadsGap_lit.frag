@@ -0,0 +1,30 @@
+#version 450 core
+
+layout(std140, binding = 0) uniform Block
+{
+    float s0;
+    float s1;
+    float s2;
+    vec4  v;
+} block;
+
+layout(location = 0) out vec4 fragColor;
+
+void main()
+{
+    fragColor = block.v * (block.s0 + block.s1 + block.s2);
+}
+// BEGIN_SHADERTEST
+/*
+; Check that the unused dword between s2 and v is not fetched: s0 and s1 merge into one load, s2 and v stay separate.
+; RUN: amdllpc -merge-scalar-buffer-loads -spvgen-dir=%spvgendir% -v %gfxip %s | FileCheck -check-prefix=SHADERTEST %s
+
+; SHADERTEST-LABEL: {{^// LLPC}} pipeline patching results
+; SHADERTEST-DAG: call <2 x i32> @llvm.amdgcn.s.buffer.load.v2i32(<4 x i32> %{{[0-9]*}}, i32 0, i32 0)
+; SHADERTEST-DAG: call i32 @llvm.amdgcn.s.buffer.load.i32(<4 x i32> %{{[0-9]*}}, i32 8, i32 0)
+; SHADERTEST-DAG: call <4 x i32> @llvm.amdgcn.s.buffer.load.v4i32(<4 x i32> %{{[0-9]*}}, i32 16, i32 0)
+; SHADERTEST-NOT: call {{.*}} @llvm.amdgcn.s.buffer.load
+
+; SHADERTEST: AMDLLPC SUCCESS
+*/
+// END_SHADERTEST
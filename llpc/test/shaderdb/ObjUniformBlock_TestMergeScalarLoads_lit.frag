@@ -0,0 +1,33 @@
+#version 450 core
+
+layout(std140, binding = 0) uniform Block
+{
+    vec4  v[4];
+    float s0;
+    float s1;
+} block;
+
+layout(location = 0) out vec4 fragColor;
+
+void main()
+{
+    fragColor = (block.v[0] + block.v[1] + block.v[2] + block.v[3]) * block.s0 * block.s1;
+}
+// BEGIN_SHADERTEST
+/*
+; RUN: amdllpc -merge-scalar-buffer-loads -spvgen-dir=%spvgendir% -v %gfxip %s | FileCheck -check-prefix=SHADERTEST %s
+
+; SHADERTEST-LABEL: {{^// LLPC}} pipeline patching results
+; SHADERTEST-NOT: call <4 x i32> @llvm.amdgcn.s.buffer.load.v4i32
+; SHADERTEST-DAG: call <16 x i32> @llvm.amdgcn.s.buffer.load.v16i32(<4 x i32> %{{[0-9]*}}, i32 0, i32 0)
+; SHADERTEST-DAG: call <2 x i32> @llvm.amdgcn.s.buffer.load.v2i32(<4 x i32> %{{[0-9]*}}, i32 64, i32 0)
+; SHADERTEST-NOT: call {{.*}} @llvm.amdgcn.s.buffer.load
+
+; SHADERTEST-LABEL: _amdgpu_ps_main:
+; SHADERTEST-NOT: s_buffer_load_dword
+; SHADERTEST-COUNT-2: s_buffer_load_dword{{x16|x2}}
+; SHADERTEST-NOT: s_buffer_load_dword
+
+; SHADERTEST: AMDLLPC SUCCESS
+*/
+// END_SHADERTEST
@@ -34,6 +34,7 @@
 #endif
 
 #include "amdllpc.h"
+#include "lgc/LgcContext.h"
 #include "llvm/AsmParser/Parser.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/LLVMContext.h"
@@ -61,6 +62,9 @@
 #endif
 #endif
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <sstream>
 #include <stdlib.h> // getenv
 
@@ -232,6 +236,39 @@ static cl::opt<bool> EnableRelocatableShaderElf("enable-relocatable-shader-elf",
                                                 cl::desc("Compile pipelines using relocatable shader elf"),
                                                 cl::init(false));
 
+// -print-included-llvm-ir: print the LLVM IR that the pipeline ELF includes as bitcode
+static cl::opt<bool> PrintIncludedLlvmIr("print-included-llvm-ir",
+                                         cl::desc("Print LLVM IR included as bitcode (-include-llvm-bc) in the ELF"),
+                                         cl::init(false));
+
+// -async-build: build each pipeline with the asynchronous build entry points
+static cl::opt<bool> AsyncBuild("async-build",
+                                cl::desc("Build each pipeline asynchronously, queued again at each priority with one "
+                                         "build cancelled (with -async-build-threads=1, they complete in priority "
+                                         "order)"),
+                                cl::init(false));
+
+// -tiered-build: build each pipeline with the tiered build entry points
+static cl::opt<bool> TieredBuild("tiered-build",
+                                 cl::desc("Build each pipeline in two tiers: a fast build, which is the output, and an "
+                                          "optimized build queued asynchronously"),
+                                 cl::init(false));
+
+// -cancel-build: build each pipeline with its cancel flag already set
+static cl::opt<bool> CancelBuild("cancel-build",
+                                 cl::desc("Build each pipeline with its cancel flag already set, so the build is "
+                                          "cancelled"),
+                                 cl::init(false));
+
+// -build-time-limit-ms: time limit for each pipeline build
+static cl::opt<unsigned> BuildTimeLimitMs("build-time-limit-ms",
+                                          cl::desc("Time limit in milliseconds after which each pipeline build is "
+                                                   "cancelled (0 for no limit)"),
+                                          cl::init(0));
+
+// Cancel flag given to each pipeline build with -cancel-build
+static const std::atomic<bool> BuildCancelFlag(true);
+
 // -check-auto-layout-compatible: check if auto descriptor layout got from spv file is commpatible with real layout
 static cl::opt<bool> CheckAutoLayoutCompatible(
     "check-auto-layout-compatible",
@@ -538,6 +575,254 @@ void *VKAPI_CALL allocateBuffer(void *instance, void *userData, size_t size) {
   return allocBuf;
 }
 
+// State shared by the asynchronous builds of a pipeline (-async-build, -tiered-build).
+struct AsyncBuildState {
+  std::mutex mutex;                // Mutex for the fields below
+  std::condition_variable changed; // Signalled when any of the fields below changes
+  std::vector<void *> buffers;     // Output buffers allocated for the builds
+  unsigned pending;                // Number of queued builds whose callback has not returned yet
+  bool firstStarted;               // Whether the callback of the first build has been called
+  bool released;                   // Whether the callback of the first build may return
+  Result result;                   // Result of the first build that failed, other than by being cancelled
+};
+
+// One asynchronous build of a pipeline (-async-build, -tiered-build).
+template <typename BuildOut> struct AsyncBuildRequest {
+  AsyncBuildState *state; // Shared state
+  const char *name;       // Name printed when the build completes
+  bool isFirst;           // Whether this is the first build, which holds its compiler thread until released
+  BuildOut *keepOut;      // Where to copy the output of the build, or null if it is not kept
+};
+
+// =====================================================================================================================
+// Callback function to allocate buffer for a pipeline built asynchronously (-async-build, -tiered-build). The builds
+// complete in any order on the compiler threads, so all the buffers are recorded in the shared state.
+//
+// @param instance : Dummy instance object, unused
+// @param userData : Shared state of the asynchronous builds
+// @param size : Requested allocation size
+void *VKAPI_CALL allocateAsyncBuffer(void *instance, void *userData, size_t size) {
+  void *allocBuf = malloc(size);
+  memset(allocBuf, 0, size);
+
+  AsyncBuildState *state = reinterpret_cast<AsyncBuildState *>(userData);
+  std::lock_guard<std::mutex> lock(state->mutex);
+  state->buffers.push_back(allocBuf);
+  return allocBuf;
+}
+
+// =====================================================================================================================
+// Callback function called when an asynchronous build of a pipeline completes or is cancelled (-async-build,
+// -tiered-build).
+//
+// @param callbackData : The build request
+// @param result : Result of the build
+// @param pipelineOut : Output of the build, or null if it was cancelled
+template <typename BuildOut>
+static void asyncBuildDone(void *callbackData, Result result, const BuildOut *pipelineOut) {
+  auto request = reinterpret_cast<AsyncBuildRequest<BuildOut> *>(callbackData);
+  AsyncBuildState *state = request->state;
+  std::unique_lock<std::mutex> lock(state->mutex);
+  if (request->isFirst) {
+    // Keep the compiler thread busy until the other builds have been queued.
+    state->firstStarted = true;
+    state->changed.notify_all();
+    state->changed.wait(lock, [state]() { return state->released; });
+  }
+
+  const char *resultName = "failed";
+  if (result == Result::Success)
+    resultName = "success";
+  else if (result == Result::ErrorCancelled)
+    resultName = "cancelled";
+  outs() << "AMDLLPC async build " << request->name << ": " << resultName << "\n";
+  outs().flush();
+
+  if (result != Result::Success && result != Result::ErrorCancelled && state->result == Result::Success)
+    state->result = result;
+  if (request->keepOut && result == Result::Success)
+    *request->keepOut = *pipelineOut;
+  --state->pending;
+  state->changed.notify_all();
+}
+
+// =====================================================================================================================
+// Queues an asynchronous build of a graphics pipeline (-async-build).
+//
+// @param compiler : LLPC compiler object
+// @param pipelineInfo : Info to build the pipeline
+// @param priority : Priority of the build
+// @param request : The build request, passed to the callback
+// @param [out] handle : Handle of the queued build
+static Result queueAsyncBuild(ICompiler *compiler, const GraphicsPipelineBuildInfo *pipelineInfo,
+                              AsyncBuildPriority priority, AsyncBuildRequest<GraphicsPipelineBuildOut> *request,
+                              AsyncBuildHandle *handle) {
+  return compiler->BuildGraphicsPipelineAsync(pipelineInfo, priority, asyncBuildDone<GraphicsPipelineBuildOut>,
+                                              request, handle);
+}
+
+// =====================================================================================================================
+// Queues an asynchronous build of a compute pipeline (-async-build).
+//
+// @param compiler : LLPC compiler object
+// @param pipelineInfo : Info to build the pipeline
+// @param priority : Priority of the build
+// @param request : The build request, passed to the callback
+// @param [out] handle : Handle of the queued build
+static Result queueAsyncBuild(ICompiler *compiler, const ComputePipelineBuildInfo *pipelineInfo,
+                              AsyncBuildPriority priority, AsyncBuildRequest<ComputePipelineBuildOut> *request,
+                              AsyncBuildHandle *handle) {
+  return compiler->BuildComputePipelineAsync(pipelineInfo, priority, asyncBuildDone<ComputePipelineBuildOut>,
+                                             request, handle);
+}
+
+// =====================================================================================================================
+// Builds a graphics pipeline with the tiered build entry point (-tiered-build).
+//
+// @param compiler : LLPC compiler object
+// @param pipelineInfo : Info to build the pipeline
+// @param [out] pipelineOut : Output of the fast build
+// @param request : The request for the optimized build, passed to the callback
+static Result buildTiered(ICompiler *compiler, const GraphicsPipelineBuildInfo *pipelineInfo,
+                          GraphicsPipelineBuildOut *pipelineOut, AsyncBuildRequest<GraphicsPipelineBuildOut> *request) {
+  return compiler->BuildGraphicsPipelineTiered(pipelineInfo, pipelineOut, AsyncBuildPriority::Normal,
+                                               asyncBuildDone<GraphicsPipelineBuildOut>, request);
+}
+
+// =====================================================================================================================
+// Builds a compute pipeline with the tiered build entry point (-tiered-build).
+//
+// @param compiler : LLPC compiler object
+// @param pipelineInfo : Info to build the pipeline
+// @param [out] pipelineOut : Output of the fast build
+// @param request : The request for the optimized build, passed to the callback
+static Result buildTiered(ICompiler *compiler, const ComputePipelineBuildInfo *pipelineInfo,
+                          ComputePipelineBuildOut *pipelineOut, AsyncBuildRequest<ComputePipelineBuildOut> *request) {
+  return compiler->BuildComputePipelineTiered(pipelineInfo, pipelineOut, AsyncBuildPriority::Normal,
+                                              asyncBuildDone<ComputePipelineBuildOut>, request);
+}
+
+// =====================================================================================================================
+// Waits for the asynchronous builds of a pipeline to complete, then keeps the buffer holding the output, and frees
+// the others.
+//
+// @param [in/out] state : Shared state of the asynchronous builds
+// @param output : The output that is kept
+// @param [in/out] compileInfo : Compilation info of LLPC standalone tool
+static void finishAsyncBuilds(AsyncBuildState &state, const void *output, CompileInfo *compileInfo) {
+  {
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.released = true;
+    state.changed.notify_all();
+    state.changed.wait(lock, [&state]() { return state.pending == 0; });
+  }
+
+  for (void *buffer : state.buffers) {
+    if (buffer == output)
+      compileInfo->pipelineBuf = buffer;
+    else
+      free(buffer);
+  }
+}
+
+// =====================================================================================================================
+// Builds a pipeline in two tiers (-tiered-build). The fast build is the output, and the optimized build is waited for.
+//
+// @param compiler : LLPC compiler object
+// @param pipelineInfo : Info to build the pipeline
+// @param [out] pipelineOut : Output of the fast build
+// @param [in/out] compileInfo : Compilation info of LLPC standalone tool
+template <typename BuildInfo, typename BuildOut>
+static Result buildPipelineTiered(ICompiler *compiler, const BuildInfo *pipelineInfo, BuildOut *pipelineOut,
+                                  CompileInfo *compileInfo) {
+  AsyncBuildState state;
+  state.pending = 1;
+  state.firstStarted = false;
+  state.released = false;
+  state.result = Result::Success;
+
+  BuildInfo asyncPipelineInfo = *pipelineInfo;
+  asyncPipelineInfo.pUserData = &state;
+  asyncPipelineInfo.pfnOutputAlloc = allocateAsyncBuffer;
+
+  AsyncBuildRequest<BuildOut> request = {&state, "optimized", false, nullptr};
+  Result result = buildTiered(compiler, &asyncPipelineInfo, pipelineOut, &request);
+  if (result != Result::Success) {
+    // The optimized build was not queued.
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.pending = 0;
+  } else {
+    outs() << "AMDLLPC tiered build: fast build done\n";
+    outs().flush();
+  }
+
+  finishAsyncBuilds(state, pipelineOut->pipelineBin.pCode, compileInfo);
+  if (result == Result::Success)
+    result = state.result;
+  return result;
+}
+
+// =====================================================================================================================
+// Builds a pipeline with the asynchronous build entry points (-async-build).
+//
+// The pipeline is queued once, and the callback of that first build holds its compiler thread until the pipeline has
+// been queued again at each priority, and one of those builds has been cancelled. With a single compiler thread, the
+// remaining builds then complete in priority order. The output is that of the first build.
+//
+// @param compiler : LLPC compiler object
+// @param pipelineInfo : Info to build the pipeline
+// @param [out] pipelineOut : Output of the first build
+// @param [in/out] compileInfo : Compilation info of LLPC standalone tool
+template <typename BuildInfo, typename BuildOut>
+static Result buildPipelineAsync(ICompiler *compiler, const BuildInfo *pipelineInfo, BuildOut *pipelineOut,
+                                 CompileInfo *compileInfo) {
+  AsyncBuildState state;
+  state.pending = 0;
+  state.firstStarted = false;
+  state.released = false;
+  state.result = Result::Success;
+
+  BuildInfo asyncPipelineInfo = *pipelineInfo;
+  asyncPipelineInfo.pUserData = &state;
+  asyncPipelineInfo.pfnOutputAlloc = allocateAsyncBuffer;
+
+  static const struct {
+    const char *name;
+    AsyncBuildPriority priority;
+  } Builds[] = {
+      {"first", AsyncBuildPriority::Normal},           {"background", AsyncBuildPriority::Background},
+      {"normal", AsyncBuildPriority::Normal},          {"interactive", AsyncBuildPriority::Interactive},
+      {"cancelled", AsyncBuildPriority::Background},
+  };
+  AsyncBuildRequest<BuildOut> requests[sizeof(Builds) / sizeof(Builds[0])];
+  AsyncBuildHandle handle = 0;
+  Result result = Result::Success;
+  for (unsigned i = 0; i < sizeof(Builds) / sizeof(Builds[0]) && result == Result::Success; ++i) {
+    requests[i] = {&state, Builds[i].name, i == 0, i == 0 ? pipelineOut : nullptr};
+    {
+      std::lock_guard<std::mutex> lock(state.mutex);
+      ++state.pending;
+    }
+    result = queueAsyncBuild(compiler, &asyncPipelineInfo, Builds[i].priority, &requests[i], &handle);
+    if (result != Result::Success) {
+      std::lock_guard<std::mutex> lock(state.mutex);
+      --state.pending;
+    } else if (i == 0) {
+      // Wait for a compiler thread to pick up the first build, so that it does not compete with the others.
+      std::unique_lock<std::mutex> lock(state.mutex);
+      state.changed.wait(lock, [&state]() { return state.firstStarted; });
+    }
+  }
+  // Cancel the last build, which is still queued behind the others.
+  if (result == Result::Success)
+    result = compiler->CancelAsyncBuild(handle);
+
+  finishAsyncBuilds(state, pipelineOut->pipelineBin.pCode, compileInfo);
+  if (result == Result::Success)
+    result = state.result;
+  return result;
+}
+
 // =====================================================================================================================
 // Checks whether the specified file name represents a SPIR-V assembly text file (.spvasm).
 static bool isSpirvTextFile(const std::string &fileName) {
@@ -824,6 +1109,14 @@ static Result decodePipelineBinary(const BinaryData *pipelineBin, CompileInfo *c
     LLPC_OUTS("===============================================================================\n");
     LLPC_OUTS("// LLPC final ELF info\n");
     LLPC_OUTS(reader);
+
+    if (PrintIncludedLlvmIr && EnableOuts()) {
+      outs() << "===============================================================================\n";
+      outs() << "// LLPC included LLVM IR\n";
+      StringRef elf(static_cast<const char *>(pipelineBin->pCode), pipelineBin->codeSize);
+      if (!lgc::LgcContext::printIncludedLlvmIr(elf, outs()))
+        outs() << "(none)\n";
+    }
   }
 
   return Result::Success;
@@ -1042,6 +1335,8 @@ static Result buildPipeline(ICompiler *compiler, CompileInfo *compileInfo) {
 
     pipelineInfo->options.robustBufferAccess = RobustBufferAccess;
     pipelineInfo->options.enableRelocatableShaderElf = EnableRelocatableShaderElf;
+    pipelineInfo->pCancelFlag = CancelBuild ? &BuildCancelFlag : nullptr;
+    pipelineInfo->timeLimitMs = BuildTimeLimitMs;
 
     void *pipelineDumpHandle = nullptr;
     if (cl::EnablePipelineDump) {
@@ -1062,7 +1357,15 @@ static Result buildPipeline(ICompiler *compiler, CompileInfo *compileInfo) {
       outs().flush();
     }
 
-    result = compiler->BuildGraphicsPipeline(pipelineInfo, pipelineOut, pipelineDumpHandle);
+    if (AsyncBuild)
+      result = buildPipelineAsync(compiler, pipelineInfo, pipelineOut, compileInfo);
+    else if (TieredBuild)
+      result = buildPipelineTiered(compiler, pipelineInfo, pipelineOut, compileInfo);
+    else
+      result = compiler->BuildGraphicsPipeline(pipelineInfo, pipelineOut, pipelineDumpHandle);
+
+    if (result == Result::ErrorCancelled)
+      LLPC_ERRS("Graphics pipeline build cancelled\n");
 
     if (result == Result::Success) {
       if (cl::EnablePipelineDump) {
@@ -1117,6 +1420,8 @@ static Result buildPipeline(ICompiler *compiler, CompileInfo *compileInfo) {
     pipelineInfo->unlinked = compileInfo->unlinked;
     pipelineInfo->options.robustBufferAccess = RobustBufferAccess;
     pipelineInfo->options.enableRelocatableShaderElf = EnableRelocatableShaderElf;
+    pipelineInfo->pCancelFlag = CancelBuild ? &BuildCancelFlag : nullptr;
+    pipelineInfo->timeLimitMs = BuildTimeLimitMs;
 
     void *pipelineDumpHandle = nullptr;
     if (cl::EnablePipelineDump) {
@@ -1136,7 +1441,15 @@ static Result buildPipeline(ICompiler *compiler, CompileInfo *compileInfo) {
       outs().flush();
     }
 
-    result = compiler->BuildComputePipeline(pipelineInfo, pipelineOut, pipelineDumpHandle);
+    if (AsyncBuild)
+      result = buildPipelineAsync(compiler, pipelineInfo, pipelineOut, compileInfo);
+    else if (TieredBuild)
+      result = buildPipelineTiered(compiler, pipelineInfo, pipelineOut, compileInfo);
+    else
+      result = compiler->BuildComputePipeline(pipelineInfo, pipelineOut, pipelineDumpHandle);
+
+    if (result == Result::ErrorCancelled)
+      LLPC_ERRS("Compute pipeline build cancelled\n");
 
     if (result == Result::Success) {
       if (cl::EnablePipelineDump) {
@@ -1670,6 +1983,13 @@ int main(int argc, char *argv[]) {
   }
 
   assert(!isFailure());
+
+  if (cl::EnablePipelineDump) {
+    // Pipeline dump files are written in the background, so wait for them to be complete before exiting.
+    unsigned droppedDumps = IPipelineDumper::FlushPipelineDumps();
+    LLPC_OUTS("Pipeline dumps flushed, " << droppedDumps << " dump files dropped\n");
+  }
+
   compiler->Destroy();
   LLPC_OUTS("\n=====  AMDLLPC SUCCESS  =====\n");
   return 0;
@@ -30,6 +30,7 @@
  */
 #include "llpcElfWriter.h"
 #include "llpcContext.h"
+#include "lgc/LgcContext.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/BinaryFormat/MsgPackDocument.h"
 #include <algorithm>
@@ -74,80 +75,100 @@ template <class Elf> ElfWriter<Elf>::~ElfWriter() {
 }
 
 // =====================================================================================================================
-// Merge base section and input section into merged section
+// Records the merge of the base section at the given index with the input section. The merged section is not built
+// here: it is described by a list of chunks that refer to the two source sections, and writeToBuffer copies them
+// straight into the output ELF. Both source sections must stay alive until then.
 //
-// @param pSection1 : The first section buffer to merge
-// @param section1Size : Byte size of the first section
-// @param pPrefixString1 : Prefix string of the first section's contents
-// @param pSection2 : The second section buffer to merge
-// @param section2Offset : Byte offset of the second section
-// @param pPrefixString2 : Prefix string of the second section's contents
-// @param [out] pNewSection : Merged section
+// @param secIndex : Index of the base section, which is replaced by the merged section
+// @param section1Size : Byte size of the base section to keep
+// @param prefixString1 : Prefix string of the base section's contents
+// @param section2 : The input section to merge
+// @param section2Offset : Byte offset of the input section
+// @param prefixString2 : Prefix string of the input section's contents
 template <class Elf>
-void ElfWriter<Elf>::mergeSection(const SectionBuffer *pSection1, size_t section1Size, const char *pPrefixString1,
-                                  const SectionBuffer *pSection2, size_t section2Offset, const char *pPrefixString2,
-                                  SectionBuffer *pNewSection) {
-  std::string prefix1;
-  std::string prefix2;
+void ElfWriter<Elf>::addMergedSection(unsigned secIndex, size_t section1Size, const char *prefixString1,
+                                      const SectionBuffer *section2, size_t section2Offset, const char *prefixString2) {
+  assert(secIndex < m_sections.size());
+  assert(m_mergedSections.count(secIndex) == 0);
+  SectionBuffer *section1 = &m_sections[secIndex];
+  MergedSection &merged = m_mergedSections[secIndex];
+  merged.baseSize = section1->secHead.sh_size;
 
   // Build prefix1 if it is needed
-  if (pPrefixString1) {
-    if (strncmp(reinterpret_cast<const char *>(pSection1->data), pPrefixString1, strlen(pPrefixString1)) != 0) {
-      prefix1 = pPrefixString1;
-      prefix1 += ":\n";
+  SectionChunk chunk1 = {};
+  if (prefixString1) {
+    if (strncmp(reinterpret_cast<const char *>(section1->data), prefixString1, strlen(prefixString1)) != 0) {
+      chunk1.text = prefixString1;
+      chunk1.text += ":\n";
     }
   }
 
+  // Base section content, padded with NOP instructions to match backend's behavior.
+  // NOTE: All disassemble section don't have any alignmeent requirement, so padding happens only if we merge
+  // .text section.
+  auto baseCopySize = std::min(section1Size, static_cast<size_t>(section1->secHead.sh_size));
+  chunk1.data = section1->data;
+  chunk1.size = baseCopySize;
+  merged.chunks.push_back(chunk1);
+  if (baseCopySize < section1Size)
+    merged.chunks.push_back({"", nullptr, section1Size - baseCopySize});
+
   // Build appendPrefixString if it is needed
-  if (pPrefixString2) {
-    if (strncmp(reinterpret_cast<const char *>(pSection2->data + section2Offset), pPrefixString2,
-                strlen(pPrefixString2)) != 0) {
-      prefix2 = pPrefixString2;
-      prefix2 += ":\n";
+  SectionChunk chunk2 = {};
+  if (prefixString2) {
+    if (strncmp(reinterpret_cast<const char *>(section2->data + section2Offset), prefixString2,
+                strlen(prefixString2)) != 0) {
+      chunk2.text = prefixString2;
+      chunk2.text += ":\n";
     }
   }
 
-  // Build merged section
-  size_t newSectionSize =
-      section1Size + (pSection2->secHead.sh_size - section2Offset) + prefix1.length() + prefix2.length();
-
-  auto mergedData = new uint8_t[newSectionSize];
-  *pNewSection = *pSection1;
-  pNewSection->data = mergedData;
-  pNewSection->secHead.sh_size = newSectionSize;
+  // Append section content
+  chunk2.data = section2->data + section2Offset;
+  chunk2.size = section2->secHead.sh_size - section2Offset;
+  merged.chunks.push_back(chunk2);
 
-  auto data = mergedData;
-
-  // Copy prefix1
-  if (prefix1.length() > 0) {
-    memcpy(data, prefix1.data(), prefix1.length());
-    data += prefix1.length();
-  }
+  size_t newSectionSize = 0;
+  for (const SectionChunk &chunk : merged.chunks)
+    newSectionSize += chunk.text.length() + chunk.size;
+  section1->secHead.sh_size = newSectionSize;
+}
 
-  // Copy base section content
-  auto baseCopySize = std::min(section1Size, static_cast<size_t>(pSection1->secHead.sh_size));
-  memcpy(data, pSection1->data, baseCopySize);
-  data += baseCopySize;
-
-  // Fill alignment data with NOP instruction to match backend's behavior
-  if (baseCopySize < section1Size) {
-    // NOTE: All disassemble section don't have any alignmeent requirement, so it happen only if we merge
-    // .text section.
-    constexpr unsigned nop = 0xBF800000;
-    unsigned *dataDw = reinterpret_cast<unsigned *>(data);
-    for (unsigned i = 0; i < (section1Size - baseCopySize) / sizeof(unsigned); ++i)
-      dataDw[i] = nop;
-    data += (section1Size - baseCopySize);
-  }
+// =====================================================================================================================
+// Writes the chunks of a merged section to the output buffer.
+//
+// @param merged : Merged section
+// @param [out] buffer : Output buffer, which must have room for the whole merged section
+template <class Elf> void ElfWriter<Elf>::writeMergedSection(const MergedSection &merged, char *buffer) {
+  for (const SectionChunk &chunk : merged.chunks) {
+    if (!chunk.text.empty()) {
+      memcpy(buffer, chunk.text.data(), chunk.text.length());
+      buffer += chunk.text.length();
+    }
 
-  // Copy append prefix
-  if (prefix2.length() > 0) {
-    memcpy(data, prefix2.data(), prefix2.length());
-    data += prefix2.length();
+    if (chunk.data) {
+      memcpy(buffer, chunk.data, chunk.size);
+    } else {
+      constexpr unsigned nop = 0xBF800000;
+      for (size_t i = 0; i < chunk.size / sizeof(unsigned); ++i)
+        memcpy(buffer + i * sizeof(unsigned), &nop, sizeof(unsigned));
+    }
+    buffer += chunk.size;
   }
+}
 
-  // Copy append section content
-  memcpy(data, pSection2->data + section2Offset, pSection2->secHead.sh_size - section2Offset);
+// =====================================================================================================================
+// Finds the byte offset of the first occurrence of a symbol name in a text section, without relying on the section
+// being null terminated.
+//
+// @param section : Text section to search
+// @param symbolName : Symbol name to search for
+// @param notFoundOffset : Offset to return if the symbol name is not found
+template <class Elf>
+size_t ElfWriter<Elf>::findSymbolInText(const SectionBuffer *section, const char *symbolName, size_t notFoundOffset) {
+  StringRef text(reinterpret_cast<const char *>(section->data), section->secHead.sh_size);
+  size_t offset = text.find(symbolName);
+  return offset == StringRef::npos ? notFoundOffset : offset;
 }
 
 // =====================================================================================================================
@@ -603,10 +624,14 @@ template <class Elf> void ElfWriter<Elf>::writeToBuffer(ElfPackage *pElf) {
   assert(m_header.e_phnum == 0);
 
   // Write each section buffer
-  for (auto &section : m_sections) {
+  for (unsigned secIdx = 0; secIdx < m_sections.size(); ++secIdx) {
+    auto &section = m_sections[secIdx];
     section.secHead.sh_offset = static_cast<unsigned>(buffer - data);
     const unsigned sizeBytes = section.secHead.sh_size;
-    if (sizeBytes > 0)
+    auto merged = m_mergedSections.find(secIdx);
+    if (merged != m_mergedSections.end())
+      writeMergedSection(merged->second, buffer);
+    else if (sizeBytes > 0)
       memcpy(buffer, section.data, sizeBytes);
     buffer += alignTo(sizeBytes, sizeof(unsigned));
   }
@@ -908,10 +933,7 @@ void ElfWriter<Elf>::mergeElfBinary(Context *pContext, const BinaryData *pFragme
     if (strcmp(fragmentSymbol.pSymName, fragmentIsaSymbolName) == 0) {
       // Modify ISA code
       fragmentIsaSymbol = &fragmentSymbol;
-      ElfSectionBuffer<Elf64::SectionHeader> newSection = {};
-      mergeSection(nonFragmentTextSection, isaOffset, nullptr, fragmentTextSection, fragmentIsaSymbol->value, nullptr,
-                   &newSection);
-      setSection(nonFragmentSecIndex, &newSection);
+      addMergedSection(nonFragmentSecIndex, isaOffset, nullptr, fragmentTextSection, fragmentIsaSymbol->value, nullptr);
     }
 
     if (!fragmentIsaSymbol)
@@ -945,31 +967,14 @@ void ElfWriter<Elf>::mergeElfBinary(Context *pContext, const BinaryData *pFragme
   getSectionDataBySectionIndex(nonFragmentDisassemblySecIndex, &nonFragmentDisassemblySection);
   if (nonFragmentDisassemblySection) {
     assert(fragmentDisassemblySection);
-    // NOTE: We have to replace last character with null terminator and restore it afterwards. Otherwise, the
-    // text search will be incorrect. It is only needed for ElfReader, ElfWriter always append a null terminator
-    // for all section data.
-    auto fragmentDisassemblySectionEnd =
-        fragmentDisassemblySection->data + fragmentDisassemblySection->secHead.sh_size - 1;
-    uint8_t lastChar = *fragmentDisassemblySectionEnd;
-    const_cast<uint8_t *>(fragmentDisassemblySectionEnd)[0] = '\0';
-    auto fragmentDisassembly =
-        strstr(reinterpret_cast<const char *>(fragmentDisassemblySection->data), fragmentIsaSymbolName);
-    const_cast<uint8_t *>(fragmentDisassemblySectionEnd)[0] = lastChar;
-
-    auto fragmentDisassemblyOffset =
-        !fragmentDisassembly ? 0
-                             : (fragmentDisassembly - reinterpret_cast<const char *>(fragmentDisassemblySection->data));
-
-    auto disassemblyEnd =
-        strstr(reinterpret_cast<const char *>(nonFragmentDisassemblySection->data), fragmentIsaSymbolName);
-    auto disassemblySize = !disassemblyEnd
-                               ? nonFragmentDisassemblySection->secHead.sh_size
-                               : disassemblyEnd - reinterpret_cast<const char *>(nonFragmentDisassemblySection->data);
-
-    ElfSectionBuffer<Elf64::SectionHeader> newSection = {};
-    mergeSection(nonFragmentDisassemblySection, disassemblySize, firstIsaSymbolName.c_str(), fragmentDisassemblySection,
-                 fragmentDisassemblyOffset, fragmentIsaSymbolName, &newSection);
-    setSection(nonFragmentDisassemblySecIndex, &newSection);
+    // NOTE: The fragment sections point into the cached fragment ELF, which must not be modified, so the searches
+    // are bounded by the section size rather than by a null terminator.
+    auto fragmentDisassemblyOffset = findSymbolInText(fragmentDisassemblySection, fragmentIsaSymbolName, 0);
+    auto disassemblySize = findSymbolInText(nonFragmentDisassemblySection, fragmentIsaSymbolName,
+                                            nonFragmentDisassemblySection->secHead.sh_size);
+
+    addMergedSection(nonFragmentDisassemblySecIndex, disassemblySize, firstIsaSymbolName.c_str(),
+                     fragmentDisassemblySection, fragmentDisassemblyOffset, fragmentIsaSymbolName);
   }
 
   // Merge LLVM IR disassemble
@@ -984,28 +989,39 @@ void ElfWriter<Elf>::mergeElfBinary(Context *pContext, const BinaryData *pFragme
 
   if (nonFragmentLlvmIrSection) {
     assert(fragmentLlvmIrSection);
+    auto fragmentLlvmIrOffset = findSymbolInText(fragmentLlvmIrSection, fragmentIsaSymbolName, 0);
+    auto llvmIrSize =
+        findSymbolInText(nonFragmentLlvmIrSection, fragmentIsaSymbolName, nonFragmentLlvmIrSection->secHead.sh_size);
 
-    // NOTE: We have to replace last character with null terminator and restore it afterwards. Otherwise, the
-    // text search will be incorrect. It is only needed for ElfReader, ElfWriter always append a null terminator
-    // for all section data.
-    auto fragmentLlvmIrSectionEnd = fragmentLlvmIrSection->data + fragmentLlvmIrSection->secHead.sh_size - 1;
-    uint8_t lastChar = *fragmentLlvmIrSectionEnd;
-    const_cast<uint8_t *>(fragmentLlvmIrSectionEnd)[0] = '\0';
-    auto fragmentLlvmIrStart =
-        strstr(reinterpret_cast<const char *>(fragmentLlvmIrSection->data), fragmentIsaSymbolName);
-    const_cast<uint8_t *>(fragmentLlvmIrSectionEnd)[0] = lastChar;
-
-    auto fragmentLlvmIrOffset =
-        !fragmentLlvmIrStart ? 0 : (fragmentLlvmIrStart - reinterpret_cast<const char *>(fragmentLlvmIrSection->data));
-
-    auto llvmIrEnd = strstr(reinterpret_cast<const char *>(nonFragmentLlvmIrSection->data), fragmentIsaSymbolName);
-    auto llvmIrSize = !llvmIrEnd ? nonFragmentLlvmIrSection->secHead.sh_size
-                                 : llvmIrEnd - reinterpret_cast<const char *>(nonFragmentLlvmIrSection->data);
-
-    ElfSectionBuffer<Elf64::SectionHeader> newSection = {};
-    mergeSection(nonFragmentLlvmIrSection, llvmIrSize, firstIsaSymbolName.c_str(), fragmentLlvmIrSection,
-                 fragmentLlvmIrOffset, fragmentIsaSymbolName, &newSection);
-    setSection(nonFragmentLlvmIrSecIndex, &newSection);
+    addMergedSection(nonFragmentLlvmIrSecIndex, llvmIrSize, firstIsaSymbolName.c_str(), fragmentLlvmIrSection,
+                     fragmentLlvmIrOffset, fragmentIsaSymbolName);
+  }
+
+  // Merge LLVM bitcode. The stale fragment shader is removed from the non-fragment ELF's modules, and the other
+  // stages from the fragment ELF's modules, before they are put into one section.
+  ElfSectionBuffer<Elf64::SectionHeader> *fragmentLlvmBcSection = nullptr;
+  const ElfSectionBuffer<Elf64::SectionHeader> *nonFragmentLlvmBcSection = nullptr;
+
+  std::string llvmBcSectionName = lgc::LgcContext::getIncludedLlvmIrSectionName().str();
+  auto fragmentLlvmBcSecIndex = reader.GetSectionIndex(llvmBcSectionName.c_str());
+  auto nonFragmentLlvmBcSecIndex = GetSectionIndex(llvmBcSectionName.c_str());
+  reader.getSectionDataBySectionIndex(fragmentLlvmBcSecIndex, &fragmentLlvmBcSection);
+  getSectionDataBySectionIndex(nonFragmentLlvmBcSecIndex, &nonFragmentLlvmBcSection);
+
+  if (nonFragmentLlvmBcSection && fragmentLlvmBcSection) {
+    StringRef nonFragmentLlvmBc(reinterpret_cast<const char *>(nonFragmentLlvmBcSection->data),
+                                nonFragmentLlvmBcSection->secHead.sh_size);
+    StringRef fragmentLlvmBc(reinterpret_cast<const char *>(fragmentLlvmBcSection->data),
+                             fragmentLlvmBcSection->secHead.sh_size);
+    std::string mergedLlvmBc;
+    if (lgc::LgcContext::mergeIncludedLlvmIr(nonFragmentLlvmBc, fragmentLlvmBc, mergedLlvmBc)) {
+      SectionBuffer newSection = *nonFragmentLlvmBcSection;
+      auto data = new uint8_t[mergedLlvmBc.size()];
+      memcpy(data, mergedLlvmBc.data(), mergedLlvmBc.size());
+      newSection.data = data;
+      newSection.secHead.sh_size = mergedLlvmBc.size();
+      setSection(nonFragmentLlvmBcSecIndex, &newSection);
+    }
   }
 
   // Merge PAL metadata
@@ -1020,6 +1036,12 @@ void ElfWriter<Elf>::mergeElfBinary(Context *pContext, const BinaryData *pFragme
   setNote(&newMetaNote);
 
   writeToBuffer(pPipelineElf);
+
+  // The merged sections refer to the fragment ELF, which the writer does not own, so drop them now that the pipeline
+  // ELF is written.
+  for (auto &merged : m_mergedSections)
+    m_sections[merged.first].secHead.sh_size = merged.second.baseSize;
+  m_mergedSections.clear();
 }
 
 // =====================================================================================================================
@@ -66,10 +66,6 @@ public:
 
   ~ElfWriter();
 
-  static void mergeSection(const SectionBuffer *section1, size_t section1Size, const char *prefixString1,
-                           const SectionBuffer *section2, size_t section2Offset, const char *prefixString2,
-                           SectionBuffer *newSection);
-
   static void mergeMetaNote(Context *context, const ElfNote *note1, const ElfNote *note2, ElfNote *newNote);
 
   static void updateMetaNote(Context *context, const ElfNote *note, ElfNote *newNote);
@@ -111,6 +107,26 @@ private:
   ElfWriter(const ElfWriter &) = delete;
   ElfWriter &operator=(const ElfWriter &) = delete;
 
+  // A contiguous piece of a merged section
+  struct SectionChunk {
+    std::string text;    // Text written ahead of the data, may be empty
+    const uint8_t *data; // Data to copy, or nullptr to pad with NOP instructions
+    size_t size;         // Byte size of the data or padding
+  };
+
+  // A section merged from two source sections, built directly in the output buffer by writeToBuffer
+  struct MergedSection {
+    size_t baseSize;                  // Byte size of the base section before the merge
+    std::vector<SectionChunk> chunks; // Chunks of the merged section, in order
+  };
+
+  void addMergedSection(unsigned secIndex, size_t section1Size, const char *prefixString1,
+                        const SectionBuffer *section2, size_t section2Offset, const char *prefixString2);
+
+  static void writeMergedSection(const MergedSection &merged, char *buffer);
+
+  static size_t findSymbolInText(const SectionBuffer *section, const char *symbolName, size_t notFoundOffset);
+
   static void mergeMapItem(llvm::msgpack::MapDocNode &destMap, llvm::msgpack::MapDocNode &srcMap, unsigned key);
 
   size_t getRequiredBufferSizeBytes();
@@ -131,6 +147,8 @@ private:
   std::vector<ElfNote> m_notes;          // List of Elf notes
   std::vector<ElfSymbol> m_symbols;      // List of Elf symbols
 
+  std::map<unsigned, MergedSection> m_mergedSections; // Pending merged sections, keyed by section index
+
   int m_textSecIdx;   // Section index of .text section
   int m_noteSecIdx;   // Section index of .note section
   int m_relocSecIdx;  // Section index of relocation section
@@ -28,15 +28,20 @@
 * @breif VKGC source file: contains implementation of VKGC pipline dump utility.
 ***********************************************************************************************************************
 */
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include "vkgcElfReader.h"
 #include "vkgcPipelineDumper.h"
 #include "vkgcUtil.h"
+#include <condition_variable>
+#include <deque>
 #include <fstream>
+#include <mutex>
 #include <sstream>
 #include <sys/stat.h>
+#include <thread>
 #include <unordered_set>
 
 #define DEBUG_TYPE "vkgc-pipeline-dumper"
@@ -61,6 +66,7 @@ std::ostream &operator<<(std::ostream &out, NggSubgroupSizingType subgroupSizing
 std::ostream &operator<<(std::ostream &out, NggCompactMode compactMode);
 std::ostream &operator<<(std::ostream &out, DenormalMode denormalMode);
 std::ostream &operator<<(std::ostream &out, WaveBreakSize waveBreakSize);
+std::ostream &operator<<(std::ostream &out, WorkgroupIdSwizzle workgroupIdSwizzle);
 std::ostream &operator<<(std::ostream &out, ShadowDescriptorTableUsage shadowDescriptorTableUsage);
 
 template std::ostream &operator<<(std::ostream &out, ElfReader<Elf64> &reader);
@@ -85,16 +91,105 @@ private:
 // Mutex for pipeline dump
 static Mutex SDumpMutex;
 
+// -pipeline-dump-queue-kb: maximum size of pipeline dump files waiting to be written
+static cl::opt<unsigned> PipelineDumpQueueKb("pipeline-dump-queue-kb",
+                                             cl::desc("Maximum kilobytes of pipeline dump files waiting to be written "
+                                                      "before a dumping thread waits for the writer"),
+                                             cl::init(64 * 1024));
+
 // =====================================================================================================================
-// Represents the file objects for pipeline dump
+// Writes pipeline dump files on a background thread, so that compile threads format their dumps into memory and do
+// not wait for disk I/O. The queue is bounded: a thread that queues a file while the queue is full waits until the
+// writer has caught up. The writer thread is started when there is something to write and exits when the queue is
+// empty, so no thread is left to join when the library is unloaded.
+class DumpFileWriter {
+public:
+  ~DumpFileWriter() { flush(); }
+
+  // Queues a file to be written, replacing any existing file.
+  //
+  // @param pathName : Path name of the file
+  // @param contents : Contents of the file
+  void write(std::string pathName, std::string contents) {
+    const size_t maxQueuedBytes = size_t(PipelineDumpQueueKb) * 1024;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_queueChanged.wait(lock, [this, &contents, maxQueuedBytes] {
+      return m_queuedBytes == 0 || m_queuedBytes + contents.size() <= maxQueuedBytes;
+    });
+    m_queuedBytes += contents.size();
+    m_queue.emplace_back(std::move(pathName), std::move(contents));
+    if (!m_running) {
+      m_running = true;
+      std::thread(&DumpFileWriter::run, this).detach();
+    }
+  }
+
+  // Counts a dump file that could not be created, so it is dropped.
+  void countDropped() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_droppedFiles;
+  }
+
+  // Waits until all queued files have been written.
+  //
+  // @returns : Number of dump files dropped because they could not be created or written since the last flush
+  unsigned flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_queueChanged.wait(lock, [this] { return !m_running; });
+    unsigned droppedFiles = m_droppedFiles;
+    m_droppedFiles = 0;
+    return droppedFiles;
+  }
+
+private:
+  // Writes queued files until the queue is empty.
+  void run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_queue.empty()) {
+      std::pair<std::string, std::string> file = std::move(m_queue.front());
+      m_queue.pop_front();
+      lock.unlock();
+
+      std::ofstream dumpFile(file.first.c_str(), std::ios_base::binary | std::ios_base::out);
+      if (dumpFile.is_open())
+        dumpFile.write(file.second.data(), file.second.size());
+      dumpFile.close();
+      bool failed = dumpFile.fail();
+
+      lock.lock();
+      if (failed)
+        ++m_droppedFiles;
+      m_queuedBytes -= file.second.size();
+      m_queueChanged.notify_all();
+    }
+    m_running = false;
+    m_queueChanged.notify_all();
+  }
+
+  std::mutex m_mutex;                                      // Mutex guarding the members below
+  std::condition_variable m_queueChanged;                  // Signalled when a file is written or the writer stops
+  std::deque<std::pair<std::string, std::string>> m_queue; // Queued files as {path name, contents}
+  size_t m_queuedBytes = 0;                                // Total size of the contents of queued files
+  unsigned m_droppedFiles = 0;                             // Files not created or written since the last flush
+  bool m_running = false;                                  // Whether the writer thread is running
+};
+
+// Writer for all pipeline dump files
+static DumpFileWriter SDumpFileWriter;
+
+// =====================================================================================================================
+// Represents the file objects for pipeline dump. The .pipe file is formatted in memory and queued to be written when
+// the dump ends.
 struct PipelineDumpFile {
   PipelineDumpFile(const char *dumpFileName, const char *binaryFileName)
-      : dumpFile(dumpFileName), binaryIndex(0), binaryFileName(binaryFileName) {}
+      : dumpFileName(dumpFileName), binaryIndex(0), binaryFileName(binaryFileName) {}
+
+  ~PipelineDumpFile() { SDumpFileWriter.write(std::move(dumpFileName), dumpFile.str()); }
 
-  std::ofstream dumpFile;     // File object for .pipe file
-  std::ofstream binaryFile;   // File object for ELF binary
-  unsigned binaryIndex;       // ELF Binary index
-  std::string binaryFileName; // File name of binary file
+  std::ostringstream dumpFile; // Contents of .pipe file
+  std::string dumpFileName;    // File name of .pipe file
+  unsigned binaryIndex;        // ELF Binary index
+  std::string binaryFileName;  // File name of binary file
 };
 
 // =====================================================================================================================
@@ -166,6 +261,14 @@ void VKAPI_CALL IPipelineDumper::DumpPipelineExtraInfo(void *dumpFile, const cha
   PipelineDumper::DumpPipelineExtraInfo(reinterpret_cast<PipelineDumpFile *>(dumpFile), &tmpStr);
 }
 
+// =====================================================================================================================
+// Waits until all pipeline dump files have been written.
+//
+// @returns : Number of dump files dropped because they could not be created or written since the last flush
+unsigned VKAPI_CALL IPipelineDumper::FlushPipelineDumps() {
+  return SDumpFileWriter.flush();
+}
+
 // =====================================================================================================================
 // Gets shader module hash code.
 //
@@ -375,13 +478,14 @@ PipelineDumpFile *PipelineDumper::BeginPipelineDump(const PipelineDumpOptions *d
         enableDump = false;
     }
 
-    // Open dump file
+    // Create the .pipe file now, while holding the mutex. That finds a dump directory that cannot be written before
+    // the dump is formatted, and it makes a later dump see the name as taken before the contents have been written.
     if (enableDump) {
-      dumpFile = new PipelineDumpFile(dumpPathName.c_str(), dumpBinaryName.c_str());
-      if (dumpFile->dumpFile.bad()) {
-        delete dumpFile;
-        dumpFile = nullptr;
-      }
+      std::ofstream pipeFile(dumpPathName.c_str(), std::ios_base::binary | std::ios_base::out);
+      if (pipeFile.is_open())
+        dumpFile = new PipelineDumpFile(dumpPathName.c_str(), dumpBinaryName.c_str());
+      else
+        SDumpFileWriter.countDropped();
     }
 
     SDumpMutex.unlock();
@@ -562,6 +666,8 @@ void PipelineDumper::dumpPipelineShaderInfo(const PipelineShaderInfo *shaderInfo
   dumpFile << "options.disableLicmThreshold = " << shaderInfo->options.disableLicmThreshold << "\n";
   dumpFile << "options.unrollHintThreshold = " << shaderInfo->options.unrollHintThreshold << "\n";
   dumpFile << "options.dontUnrollHintThreshold = " << shaderInfo->options.dontUnrollHintThreshold << "\n";
+  dumpFile << "options.workgroupIdSwizzle = " << shaderInfo->options.workgroupIdSwizzle << "\n";
+  dumpFile << "options.workgroupIdSwizzleSize = " << shaderInfo->options.workgroupIdSwizzleSize << "\n";
   dumpFile << "\n";
 }
 
@@ -624,10 +730,8 @@ void PipelineDumper::DumpSpirvBinary(const char *dumpDir, const BinaryData *spir
   // Make sure directory exists
   createDirectory(dumpDir);
 
-  // Open dumpfile
-  std::ofstream dumpFile(pathName.c_str(), std::ios_base::binary | std::ios_base::out);
-  if (!dumpFile.bad())
-    dumpFile.write(reinterpret_cast<const char *>(spirvBin->pCode), spirvBin->codeSize);
+  SDumpFileWriter.write(std::move(pathName),
+                        std::string(reinterpret_cast<const char *>(spirvBin->pCode), spirvBin->codeSize));
 }
 
 // =====================================================================================================================
@@ -660,11 +764,8 @@ void PipelineDumper::DumpPipelineBinary(PipelineDumpFile *dumpFile, GfxIpVersion
   }
 
   dumpFile->binaryIndex++;
-  dumpFile->binaryFile.open(binaryFileName.c_str(), std::ostream::out | std::ostream::binary);
-  if (!dumpFile->binaryFile.bad()) {
-    dumpFile->binaryFile.write(reinterpret_cast<const char *>(pipelineBin->pCode), pipelineBin->codeSize);
-    dumpFile->binaryFile.close();
-  }
+  SDumpFileWriter.write(std::move(binaryFileName),
+                        std::string(reinterpret_cast<const char *>(pipelineBin->pCode), pipelineBin->codeSize));
 }
 
 // =====================================================================================================================
@@ -719,6 +820,7 @@ void PipelineDumper::dumpPipelineOptions(const PipelineOptions *options, std::os
   dumpFile << "options.extendedRobustness.robustImageAccess = " << options->extendedRobustness.robustImageAccess
            << "\n";
   dumpFile << "options.extendedRobustness.nullDescriptor = " << options->extendedRobustness.nullDescriptor << "\n";
+  dumpFile << "options.fastCompile = " << options->fastCompile << "\n";
 }
 
 // =====================================================================================================================
@@ -880,9 +982,12 @@ void PipelineDumper::dumpGraphicsPipelineInfo(std::ostream *dumpFile, const char
 // @param isCacheHash : TRUE if the hash is used by shader cache
 // @param isRelocatableShader : TRUE if we are building relocatable shader
 // @param stage : The stage for which we are building the hash. ShaderStageInvalid if building for the entire pipeline.
+// @param resourceMappingHashData : Hash data of the resource mapping from getResourceMappingHashData, or nullptr to
+//                                  compute it here
 MetroHash::Hash PipelineDumper::generateHashForGraphicsPipeline(const GraphicsPipelineBuildInfo *pipeline,
                                                                 bool isCacheHash, bool isRelocatableShader,
-                                                                unsigned stage) {
+                                                                unsigned stage,
+                                                                const std::string *resourceMappingHashData) {
   MetroHash64 hasher;
 
   switch (stage) {
@@ -914,7 +1019,10 @@ MetroHash::Hash PipelineDumper::generateHashForGraphicsPipeline(const GraphicsPi
   }
 
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
-  updateHashForResourceMappingInfo(&pipeline->resourceMapping, &hasher, isRelocatableShader);
+  if (resourceMappingHashData)
+    hasher.Update(reinterpret_cast<const uint8_t *>(resourceMappingHashData->data()), resourceMappingHashData->size());
+  else
+    updateHashForResourceMappingInfo(&pipeline->resourceMapping, &hasher, isRelocatableShader);
 #endif
 
   hasher.Update(pipeline->iaState.deviceIndex);
@@ -929,7 +1037,7 @@ MetroHash::Hash PipelineDumper::generateHashForGraphicsPipeline(const GraphicsPi
   }
 
   if (stage == ShaderStageFragment || stage == ShaderStageInvalid)
-    updateHashForFragmentState(pipeline, &hasher, isRelocatableShader);
+    updateHashForFragmentState(pipeline, isCacheHash, &hasher, isRelocatableShader);
 
   MetroHash::Hash hash = {};
   hasher.Finalize(hash.bytes);
@@ -943,14 +1051,20 @@ MetroHash::Hash PipelineDumper::generateHashForGraphicsPipeline(const GraphicsPi
 // @param pipeline : Info to build a compute pipeline
 // @param isCacheHash : TRUE if the hash is used by shader cache
 // @param isRelocatableShader : TRUE if we are building relocatable shader
+// @param resourceMappingHashData : Hash data of the resource mapping from getResourceMappingHashData, or nullptr to
+//                                  compute it here
 MetroHash::Hash PipelineDumper::generateHashForComputePipeline(const ComputePipelineBuildInfo *pipeline,
-                                                               bool isCacheHash, bool isRelocatableShader) {
+                                                               bool isCacheHash, bool isRelocatableShader,
+                                                               const std::string *resourceMappingHashData) {
   MetroHash64 hasher;
 
   updateHashForPipelineShaderInfo(ShaderStageCompute, &pipeline->cs, isCacheHash, &hasher, isRelocatableShader);
 
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
-  updateHashForResourceMappingInfo(&pipeline->resourceMapping, &hasher, isRelocatableShader);
+  if (resourceMappingHashData)
+    hasher.Update(reinterpret_cast<const uint8_t *>(resourceMappingHashData->data()), resourceMappingHashData->size());
+  else
+    updateHashForResourceMappingInfo(&pipeline->resourceMapping, &hasher, isRelocatableShader);
 #endif
 
   hasher.Update(pipeline->deviceIndex);
@@ -968,6 +1082,10 @@ MetroHash::Hash PipelineDumper::generateHashForComputePipeline(const ComputePipe
   hasher.Update(pipeline->options.extendedRobustness.robustImageAccess);
   hasher.Update(pipeline->options.extendedRobustness.nullDescriptor);
 
+  // A fast compile gives different code, but is the same pipeline as far as the driver is concerned.
+  if (isCacheHash)
+    hasher.Update(pipeline->options.fastCompile);
+
   MetroHash::Hash hash = {};
   hasher.Finalize(hash.bytes);
 
@@ -1087,6 +1205,7 @@ void PipelineDumper::updateHashForNonFragmentState(const GraphicsPipelineBuildIn
     hasher->Update(pipeline->options.extendedRobustness.robustBufferAccess);
     hasher->Update(pipeline->options.extendedRobustness.robustImageAccess);
     hasher->Update(pipeline->options.extendedRobustness.nullDescriptor);
+    hasher->Update(pipeline->options.fastCompile);
   }
 }
 
@@ -1094,13 +1213,18 @@ void PipelineDumper::updateHashForNonFragmentState(const GraphicsPipelineBuildIn
 // Update hash code from fragment pipeline state
 //
 // @param pipeline : Info to build a graphics pipeline
+// @param isCacheHash : TRUE if the hash is used by shader cache
 // @param [in/out] hasher : Hasher to generate hash code
 // @param isRelocatableShader : TRUE if we are building relocatable shader
-void PipelineDumper::updateHashForFragmentState(const GraphicsPipelineBuildInfo *pipeline, MetroHash64 *hasher,
-                                                bool isRelocatableShader) {
+void PipelineDumper::updateHashForFragmentState(const GraphicsPipelineBuildInfo *pipeline, bool isCacheHash,
+                                                MetroHash64 *hasher, bool isRelocatableShader) {
   auto rsState = &pipeline->rsState;
   hasher->Update(rsState->perSampleShading);
 
+  // A fast compile gives a different fragment shader, so it must not be found in the cache for an optimized build.
+  if (isCacheHash)
+    hasher->Update(pipeline->options.fastCompile);
+
   if (!isRelocatableShader) {
     hasher->Update(rsState->innerCoverage);
     hasher->Update(rsState->numSamples);
@@ -1220,6 +1344,8 @@ void PipelineDumper::updateHashForPipelineShaderInfo(ShaderStage stage, const Pi
       hasher->Update(options.disableLicmThreshold);
       hasher->Update(options.unrollHintThreshold);
       hasher->Update(options.dontUnrollHintThreshold);
+      hasher->Update(options.workgroupIdSwizzle);
+      hasher->Update(options.workgroupIdSwizzleSize);
     }
   }
 }
@@ -1231,8 +1357,9 @@ void PipelineDumper::updateHashForPipelineShaderInfo(ShaderStage stage, const Pi
 // @param resourceMapping : Pipeline resource mapping data
 // @param [in,out] hasher : Haher to generate hash code
 // @param isRelocatableShader : TRUE if we are building relocatable shader
-void PipelineDumper::updateHashForResourceMappingInfo(const ResourceMappingData* pResourceMapping,
-                                                      MetroHash64 *hasher, bool isRelocatableShader) {
+template <class Hasher>
+void PipelineDumper::updateHashForResourceMappingInfo(const ResourceMappingData *pResourceMapping, Hasher *hasher,
+                                                      bool isRelocatableShader) {
   hasher->Update(pResourceMapping->staticDescriptorValueCount);
   if (pResourceMapping->staticDescriptorValueCount > 0) {
       for (unsigned i = 0; i < pResourceMapping->staticDescriptorValueCount; ++i) {
@@ -1267,6 +1394,22 @@ void PipelineDumper::updateHashForResourceMappingInfo(const ResourceMappingData*
     }
   }
 }
+
+template void PipelineDumper::updateHashForResourceMappingInfo(const ResourceMappingData *pResourceMapping,
+                                                               MetroHash64 *hasher, bool isRelocatableShader);
+
+// =====================================================================================================================
+// Gets the data that updateHashForResourceMappingInfo feeds to a hasher. Walking the resource mapping once and feeding
+// this data to each hasher that needs it gives the same hashes as calling updateHashForResourceMappingInfo for each.
+//
+// @param resourceMapping : Pipeline resource mapping data
+// @param isRelocatableShader : TRUE if we are building relocatable shader
+std::string PipelineDumper::getResourceMappingHashData(const ResourceMappingData *resourceMapping,
+                                                       bool isRelocatableShader) {
+  HashDataRecorder recorder;
+  updateHashForResourceMappingInfo(resourceMapping, &recorder, isRelocatableShader);
+  return std::move(recorder.getData());
+}
 #endif
 
 // =====================================================================================================================
@@ -1277,8 +1420,9 @@ void PipelineDumper::updateHashForResourceMappingInfo(const ResourceMappingData*
 // @param userDataNode : Resource mapping node
 // @param isRootNode : TRUE if the node is in root level
 // @param [in/out] hasher : Haher to generate hash code
+template <class Hasher>
 void PipelineDumper::updateHashForResourceMappingNode(const ResourceMappingNode *userDataNode, bool isRootNode,
-                                                      MetroHash64 *hasher) {
+                                                      Hasher *hasher) {
   hasher->Update(userDataNode->type);
   hasher->Update(userDataNode->sizeInDwords);
   hasher->Update(userDataNode->offsetInDwords);
@@ -1602,6 +1746,11 @@ OStream &operator<<(OStream &out, ElfReader<Elf> &reader) {
           ++symIdx;
           startPos = endPos;
         }
+      } else if (strcmp(name + sizeof(Util::Abi::AmdGpuCommentName) - 1, "llvmbc") == 0) {
+        // Output LLVM bitcode section, which "amdllpc -print-included-llvm-ir" can turn back into text
+        out << section->name << " (size = " << section->secHead.sh_size << " bytes)\n";
+
+        outputBinary(section->data, 0, static_cast<unsigned>(section->secHead.sh_size), out);
       } else {
         // Output text based sections
         out << section->name << " (size = " << section->secHead.sh_size << " bytes)\n";
@@ -1774,6 +1923,27 @@ std::ostream &operator<<(std::ostream &out, WaveBreakSize waveBreakSize) {
   return out << string;
 }
 
+// =====================================================================================================================
+// Translates enum "WorkgroupIdSwizzle" to string and output to ostream.
+//
+// @param [out] out : Output stream
+// @param workgroupIdSwizzle : Workgroup ID swizzle mode
+std::ostream &operator<<(std::ostream &out, WorkgroupIdSwizzle workgroupIdSwizzle) {
+  const char *string = nullptr;
+  switch (workgroupIdSwizzle) {
+    CASE_CLASSENUM_TO_STRING(WorkgroupIdSwizzle, None)
+    CASE_CLASSENUM_TO_STRING(WorkgroupIdSwizzle, Tiled)
+    CASE_CLASSENUM_TO_STRING(WorkgroupIdSwizzle, Morton)
+    CASE_CLASSENUM_TO_STRING(WorkgroupIdSwizzle, ColumnStrips)
+    break;
+  default:
+    llvm_unreachable("Should never be called!");
+    break;
+  }
+
+  return out << string;
+}
+
 // =====================================================================================================================
 // Translates enum "ShadowDescriptorTableUsage" to string and output to ostream.
 //
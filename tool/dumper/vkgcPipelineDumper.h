@@ -51,6 +51,23 @@ enum PipelineDumpFilters : unsigned {
   PipelineDumpFilterVsPs = 0x10, // Disable pipeline dump for VsPs
 };
 
+// =====================================================================================================================
+// Records the data fed to it through the same Update interface as MetroHash64, so that the data can be fed to several
+// hashers without walking the structure it came from again. As MetroHash64 hashes a stream of bytes, feeding it the
+// recorded data in one piece gives the same hash as feeding it the original pieces.
+class HashDataRecorder {
+public:
+  void Update(const uint8_t *buffer, uint64_t length) {
+    m_data.append(reinterpret_cast<const char *>(buffer), static_cast<size_t>(length));
+  }
+  template <typename T> void Update(const T &value) { Update(reinterpret_cast<const uint8_t *>(&value), sizeof(T)); }
+
+  std::string &getData() { return m_data; }
+
+private:
+  std::string m_data; // Recorded data
+};
+
 class PipelineDumper {
 public:
   typedef Util::MetroHash64 MetroHash64;
@@ -67,10 +84,12 @@ public:
   static void DumpPipelineExtraInfo(PipelineDumpFile *binaryFile, const std::string *str);
 
   static MetroHash::Hash generateHashForGraphicsPipeline(const GraphicsPipelineBuildInfo *pipeline, bool isCacheHash,
-                                                         bool isRelocatableShader, unsigned stage = ShaderStageInvalid);
+                                                         bool isRelocatableShader, unsigned stage = ShaderStageInvalid,
+                                                         const std::string *resourceMappingHashData = nullptr);
 
   static MetroHash::Hash generateHashForComputePipeline(const ComputePipelineBuildInfo *pipeline, bool isCacheHash,
-                                                        bool isRelocatableShader);
+                                                        bool isRelocatableShader,
+                                                        const std::string *resourceMappingHashData = nullptr);
 
   static std::string getPipelineInfoFileName(PipelineBuildInfo pipelineInfo, const uint64_t hashCode64);
 
@@ -78,8 +97,11 @@ public:
                                               MetroHash64 *hasher, bool isRelocatableShader);
 
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
-  static void updateHashForResourceMappingInfo(const ResourceMappingData* pResourceMapping,
-                                               MetroHash64 *hasher, bool isRelocatableShader);
+  template <class Hasher>
+  static void updateHashForResourceMappingInfo(const ResourceMappingData *pResourceMapping, Hasher *hasher,
+                                               bool isRelocatableShader);
+
+  static std::string getResourceMappingHashData(const ResourceMappingData *resourceMapping, bool isRelocatableShader);
 #endif
 
   static void updateHashForVertexInputState(const VkPipelineVertexInputStateCreateInfo *vertexInput,
@@ -97,8 +119,8 @@ public:
   static void updateHashForNonFragmentState(const GraphicsPipelineBuildInfo *pipeline, bool isCacheHash,
                                             MetroHash64 *hasher, bool isRelocatableShader);
 
-  static void updateHashForFragmentState(const GraphicsPipelineBuildInfo *pipeline, MetroHash64 *hasher,
-                                         bool isRelocatableShader);
+  static void updateHashForFragmentState(const GraphicsPipelineBuildInfo *pipeline, bool isCacheHash,
+                                         MetroHash64 *hasher, bool isRelocatableShader);
 
   // Get name of register, or "" if not known
   static const char *getRegisterNameString(unsigned regNumber);
@@ -124,8 +146,9 @@ private:
                                     std::ostream &dumpFile);
   static void dumpPipelineOptions(const PipelineOptions *options, std::ostream &dumpFile);
 
+  template <class Hasher>
   static void updateHashForResourceMappingNode(const ResourceMappingNode *userDataNode, bool isRootNode,
-                                               MetroHash64 *hasher);
+                                               Hasher *hasher);
 };
 
 } // namespace Vkgc
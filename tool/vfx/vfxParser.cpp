@@ -146,6 +146,10 @@ void Document::printSelf() {
 
 // =====================================================================================================================
 // Compiles input shader source to SPIRV binary
+//
+// NOTE: The shader sections are compiled one after another. SPVGEN does not document its entry points as thread safe,
+// and glslang keeps process-wide state, so compiling them on several threads would need every call into SPVGEN to be
+// serialized, which leaves nothing worth running in parallel.
 bool Document::compileShader() {
   bool ret = true;
   for (size_t i = 0; i < m_sections[SectionTypeShader].size(); ++i) {
@@ -534,31 +538,51 @@ void Document::parseSectionShaderSource() {
 bool Document::parse(const TestCaseInfo &info) {
   bool result = true;
 
+  // Read the whole file in one go rather than a line at a time, then split it into lines the same way fgets would.
+  std::string fileContent;
+  bool fileRead = false;
   FILE *configFile = fopen(info.vfxFile.c_str(), "r");
   if (configFile) {
+    char readBuf[64 * 1024];
+    size_t readSize = 0;
+    while ((readSize = fread(readBuf, 1, sizeof(readBuf), configFile)) > 0)
+      fileContent.append(readBuf, readSize);
+    fileRead = !ferror(configFile);
+    fclose(configFile);
+  }
+
+  if (fileRead) {
     setFileName(info.vfxFile);
     char lineBuf[MaxLineBufSize];
-    char *linePtr = nullptr;
+    const char *filePos = fileContent.data();
+    const char *fileEnd = filePos + fileContent.size();
 
     while (true) {
-      linePtr = fgets(lineBuf, MaxLineBufSize, configFile);
-
-      if (!linePtr) {
+      if (filePos == fileEnd) {
         result = endSection();
         break;
       } else {
-        result = macroSubstituteLine(linePtr, m_currentLineNum + 1, &info.macros, MaxLineBufSize);
-        if (!result)
-          break;
+        // Take up to and including the next newline, limited to the size of the line buffer.
+        size_t lineLen = std::min(static_cast<size_t>(fileEnd - filePos), static_cast<size_t>(MaxLineBufSize - 1));
+        const char *newLine = static_cast<const char *>(memchr(filePos, '\n', lineLen));
+        if (newLine)
+          lineLen = newLine - filePos + 1;
+        memcpy(lineBuf, filePos, lineLen);
+        lineBuf[lineLen] = '\0';
+        filePos += lineLen;
+
+        if (!info.macros.empty()) {
+          result = macroSubstituteLine(lineBuf, m_currentLineNum + 1, &info.macros, MaxLineBufSize);
+          if (!result)
+            break;
+        }
 
-        result = parseLine(linePtr);
+        result = parseLine(lineBuf);
         if (!result)
           break;
       }
     }
 
-    fclose(configFile);
-
     if (result)
       result = validate();
 
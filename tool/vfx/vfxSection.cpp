@@ -32,7 +32,11 @@
 #include "vfxSection.h"
 #include "vfxEnumsConverter.h"
 #include "vfxParser.h"
+#include <algorithm>
 #include <inttypes.h>
+#include <mutex>
+#include <random>
+#include <stdlib.h>
 
 #ifndef VFX_DISABLE_SPVGEN
 #if VFX_INSIDE_SPVGEN
@@ -95,9 +99,48 @@ static ParserInit Init;
 // @param sectionName : Name of this section.
 Section::Section(StrToMemberAddr *addrTable, unsigned tableSize, SectionType sectionType, const char *sectionName)
     : m_sectionType(sectionType), m_sectionName(sectionName), m_lineNum(0), m_memberTable(addrTable),
-      m_tableSize(tableSize), m_isActive(false){
+      m_tableSize(tableSize), m_memberIndex(getMemberIndex(addrTable, tableSize)), m_isActive(false) {
+}
 
-                              };
+// =====================================================================================================================
+// Gets the indices of the named members of a member table sorted by name, building it on first use for the table.
+// Member tables are static and shared by all objects of a section class, so the index is built once per class.
+//
+// @param addrTable : Table to map member name to member address
+// @param tableSize : Size of above table
+const std::vector<unsigned> *Section::getMemberIndex(const StrToMemberAddr *addrTable, unsigned tableSize) {
+  static std::mutex IndexMutex;
+  static std::map<const StrToMemberAddr *, std::vector<unsigned>> MemberIndices;
+
+  std::lock_guard<std::mutex> lock(IndexMutex);
+  auto inserted = MemberIndices.insert({addrTable, {}});
+  std::vector<unsigned> &index = inserted.first->second;
+  if (inserted.second) {
+    for (unsigned i = 0; i < tableSize; ++i) {
+      if (addrTable[i].memberName)
+        index.push_back(i);
+    }
+    // Keep table order among equal names so that lookup finds the same member as a linear search would.
+    std::stable_sort(index.begin(), index.end(), [addrTable](unsigned lhs, unsigned rhs) {
+      return strcmp(addrTable[lhs].memberName, addrTable[rhs].memberName) < 0;
+    });
+  }
+  return &index;
+}
+
+// =====================================================================================================================
+// Finds a member by name with a binary search of the sorted member index.
+//
+// @param memberName : Member string name
+unsigned Section::findMember(const char *memberName) const {
+  auto it = std::lower_bound(m_memberIndex->begin(), m_memberIndex->end(), memberName,
+                             [this](unsigned index, const char *name) {
+                               return strcmp(m_memberTable[index].memberName, name) < 0;
+                             });
+  if (it != m_memberIndex->end() && strcmp(m_memberTable[*it].memberName, memberName) == 0)
+    return *it;
+  return m_tableSize;
+}
 
 // =====================================================================================================================
 // Initializes static variable m_sectionInfo
@@ -179,15 +222,12 @@ void Section::initSectionInfo() {
 // @param [out] errorMsg : Error message
 bool Section::getMemberType(unsigned lineNum, const char *memberName, MemberType *valueType, std::string *errorMsg) {
   bool result = false;
-  for (unsigned i = 0; i < m_tableSize; ++i) {
-    if (m_memberTable[i].memberName && strcmp(memberName, m_memberTable[i].memberName) == 0) {
-      result = true;
-
-      if (valueType)
-        *valueType = m_memberTable[i].memberType;
+  unsigned i = findMember(memberName);
+  if (i != m_tableSize) {
+    result = true;
 
-      break;
-    }
+    if (valueType)
+      *valueType = m_memberTable[i].memberType;
   }
 
   if (!result) {
@@ -209,16 +249,14 @@ bool Section::isSection(unsigned lineNum, const char *memberName, bool *output,
                         std::string *errorMsg) {
   bool result = false;
 
-  for (unsigned i = 0; i < m_tableSize; ++i) {
-    if (m_memberTable[i].memberName && strcmp(memberName, m_memberTable[i].memberName) == 0) {
-      result = true;
-      if (output)
-        *output = m_memberTable[i].isSection;
+  unsigned i = findMember(memberName);
+  if (i != m_tableSize) {
+    result = true;
+    if (output)
+      *output = m_memberTable[i].isSection;
 
-      if (type)
-        *type = m_memberTable[i].memberType;
-      break;
-    }
+    if (type)
+      *type = m_memberTable[i].memberType;
   }
 
   if (!result) {
@@ -513,6 +551,139 @@ bool Section::readFile(const std::string &docFilename, const std::string &fileNa
   return result;
 }
 
+#ifndef VFX_DISABLE_SPVGEN
+// =====================================================================================================================
+// Gets the directory of the on-disk cache of SPIR-V translated from shader sources, or nullptr if the cache is not
+// enabled. The cache is enabled by setting environment variable VFX_SPIRV_CACHE_DIR to an existing directory.
+static const char *getSpirvCacheDir() {
+  static const char *CacheDir = getenv("VFX_SPIRV_CACHE_DIR");
+  return CacheDir && CacheDir[0] != '\0' ? CacheDir : nullptr;
+}
+
+// =====================================================================================================================
+// Gets the SPVGEN component versions as a string for the SPIR-V cache key. They are the same for every key, so they
+// are only queried once.
+static const std::string &getSpvGenVersionKey() {
+  static const std::string VersionKey = []() {
+    std::string key;
+    for (unsigned i = 0; i < SpvGenVersionCount; ++i) {
+      unsigned version = 0;
+      unsigned revision = 0;
+      spvGetVersion(static_cast<SpvGenVersion>(i), &version, &revision);
+      key += " " + std::to_string(version) + "." + std::to_string(revision);
+    }
+    return key;
+  }();
+  return VersionKey;
+}
+
+// =====================================================================================================================
+// Checks whether shader source has an #include directive. The text of included files is not part of the SPIR-V cache
+// key, so such sources are not cached.
+//
+// NOTE: This is a text heuristic, not a preprocessor. It errs on the side of not caching for an #include in a comment
+// or an inactive #if block, but it misses an #include split by a line continuation ("#\\" then "include" on the next
+// line), or formed by a macro; such a source is cached, and a change in the included file is not seen.
+//
+// @param source : Source text
+static bool hasIncludeDirective(const std::string &source) {
+  for (size_t pos = source.find("include"); pos != std::string::npos; pos = source.find("include", pos + 1)) {
+    // Walk back over spaces to the '#', which must be the first thing on its line.
+    size_t hashPos = pos;
+    while (hashPos > 0 && (source[hashPos - 1] == ' ' || source[hashPos - 1] == '\t'))
+      --hashPos;
+    if (hashPos == 0 || source[hashPos - 1] != '#')
+      continue;
+    --hashPos;
+    while (hashPos > 0 && (source[hashPos - 1] == ' ' || source[hashPos - 1] == '\t'))
+      --hashPos;
+    if (hashPos == 0 || source[hashPos - 1] == '\n')
+      return true;
+  }
+  return false;
+}
+
+// =====================================================================================================================
+// Builds the key of a SPIR-V cache entry from everything that the translated SPIR-V depends on: the SPVGEN component
+// versions, the kind of translation, its options, the shader stage, the entry point, the source file name (which goes
+// into the debug info) and the source text.
+//
+// @param kind : Kind of translation
+// @param options : Translation options
+// @param stage : Shader stage
+// @param entryPoint : Entry point name (optional)
+// @param fileName : Source file name
+// @param source : Source text
+static std::string getSpirvCacheKey(const char *kind, unsigned options, unsigned stage, const char *entryPoint,
+                                    const std::string &fileName, const std::string &source) {
+  std::string key = kind;
+  key += getSpvGenVersionKey();
+  key += " " + std::to_string(options) + " " + std::to_string(stage) + " " + (entryPoint ? entryPoint : "") + " " +
+         fileName + "\n";
+  key += source;
+  return key;
+}
+
+// =====================================================================================================================
+// Gets the file name of a SPIR-V cache entry, which is named after the FNV-1a hash of its key.
+//
+// @param key : Key of the cache entry
+static std::string getSpirvCacheFileName(const std::string &key) {
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (char c : key) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 0x100000001B3ull;
+  }
+  char name[32];
+  snprintf(name, sizeof(name), "/%016" PRIx64 ".spv", hash);
+  return getSpirvCacheDir() + std::string(name);
+}
+
+// =====================================================================================================================
+// Looks up SPIR-V in the cache. A cache entry holds its full key, then a null terminator, then the SPIR-V, so that
+// hash collisions are detected. Returns false on a cache miss.
+//
+// @param key : Key of the cache entry
+// @param [out] spvBin : SPIR-V binary
+static bool loadCachedSpirv(const std::string &key, std::vector<uint8_t> *spvBin) {
+  FILE *inFile = fopen(getSpirvCacheFileName(key).c_str(), "rb");
+  if (!inFile)
+    return false;
+
+  std::vector<uint8_t> data;
+  uint8_t readBuf[64 * 1024];
+  size_t readSize = 0;
+  while ((readSize = fread(readBuf, 1, sizeof(readBuf), inFile)) > 0)
+    data.insert(data.end(), readBuf, readBuf + readSize);
+  fclose(inFile);
+
+  if (data.size() <= key.size() + 1 || memcmp(data.data(), key.data(), key.size()) != 0 || data[key.size()] != '\0')
+    return false;
+  spvBin->assign(data.begin() + key.size() + 1, data.end());
+  return true;
+}
+
+// =====================================================================================================================
+// Stores SPIR-V in the cache. The entry is written to a temporary file that is then renamed, so that a concurrent
+// reader never sees a partly written entry. Failures are ignored, as they only cost a later cache miss.
+//
+// @param key : Key of the cache entry
+// @param spvBin : SPIR-V binary
+static void storeCachedSpirv(const std::string &key, const std::vector<uint8_t> &spvBin) {
+  std::string fileName = getSpirvCacheFileName(key);
+  std::string tempFileName = fileName + "." + std::to_string(std::random_device()()) + ".tmp";
+  FILE *outFile = fopen(tempFileName.c_str(), "wb");
+  if (!outFile)
+    return;
+
+  bool written = fwrite(key.c_str(), 1, key.size() + 1, outFile) == key.size() + 1 &&
+                 fwrite(spvBin.data(), 1, spvBin.size(), outFile) == spvBin.size();
+  written = fclose(outFile) == 0 && written;
+  if (!written || rename(tempFileName.c_str(), fileName.c_str()) != 0)
+    remove(tempFileName.c_str());
+}
+#endif
+
 // =====================================================================================================================
 // Compiles GLSL source text file (input) to SPIR-V binary file (output).
 //
@@ -541,6 +712,14 @@ bool SectionShader::compileGlsl(const char *entryPoint, std::string *errorMsg) {
   int compileOption = SpvGenOptionDefaultDesktop | SpvGenOptionVulkanRules | SpvGenOptionDebug;
   if (m_shaderType == Hlsl || m_shaderType == HlslFile)
     compileOption |= SpvGenOptionReadHlsl;
+
+  std::string cacheKey;
+  if (getSpirvCacheDir() && !hasIncludeDirective(m_shaderSource)) {
+    cacheKey = getSpirvCacheKey("glsl", compileOption, stage, entryPoint, m_fileName, m_shaderSource);
+    if (loadCachedSpirv(cacheKey, &m_spvBin))
+      return true;
+  }
+
   bool compileResult = spvCompileAndLinkProgramEx(1, &stage, &sourceStringCount, sourceList, fileList, &entryPoint,
                                                   &program, &log, compileOption);
 
@@ -556,6 +735,9 @@ bool SectionShader::compileGlsl(const char *entryPoint, std::string *errorMsg) {
 
   if (program)
     spvDestroyProgram(program);
+
+  if (result && !cacheKey.empty())
+    storeCachedSpirv(cacheKey, m_spvBin);
 #else
   m_spvBin.resize(m_shaderSource.length() + 1);
   memcpy(m_spvBin.data(), m_shaderSource.c_str(), m_shaderSource.length() + 1);
@@ -577,6 +759,13 @@ bool SectionShader::assembleSpirv(std::string *errorMsg) {
     return false;
   }
 
+  std::string cacheKey;
+  if (getSpirvCacheDir()) {
+    cacheKey = getSpirvCacheKey("spvasm", 0, m_shaderStage, nullptr, m_fileName, m_shaderSource);
+    if (loadCachedSpirv(cacheKey, &m_spvBin))
+      return true;
+  }
+
   const char *log = nullptr;
   unsigned bufSize = static_cast<unsigned>(m_shaderSource.size()) * 4 + 1024;
   unsigned *buffer = new unsigned[bufSize / 4];
@@ -591,6 +780,9 @@ bool SectionShader::assembleSpirv(std::string *errorMsg) {
     result = false;
   }
 
+  if (result && !cacheKey.empty())
+    storeCachedSpirv(cacheKey, m_spvBin);
+
   delete[] buffer;
 #else
   m_spvBin.resize(m_shaderSource.length() + 1);
@@ -305,6 +305,9 @@ public:
 
   bool isSection(unsigned lineNum, const char *memberName, bool *output, MemberType *type, std::string *errorMsg);
 
+  // Finds a member by name, returning its index in the member table, or the table size if not found.
+  unsigned findMember(const char *memberName) const;
+
   // Has this object been configured in VFX file.
   bool isActive() { return m_isActive; }
 
@@ -319,6 +322,8 @@ public:
 private:
   Section(){};
 
+  static const std::vector<unsigned> *getMemberIndex(const StrToMemberAddr *addrTable, unsigned tableSize);
+
 public:
   static std::map<std::string, SectionInfo> m_sectionInfo; // Section info
 
@@ -328,9 +333,10 @@ protected:
   unsigned m_lineNum;        // Line number of this section
 
 private:
-  StrToMemberAddr *m_memberTable; // Member address table
-  unsigned m_tableSize;           // Address table size
-  bool m_isActive;                // If the scestion is active
+  StrToMemberAddr *m_memberTable;             // Member address table
+  unsigned m_tableSize;                       // Address table size
+  const std::vector<unsigned> *m_memberIndex; // Indices of named members in the table, sorted by name
+  bool m_isActive;                            // If the scestion is active
 };
 
 // =====================================================================================================================
@@ -352,17 +358,15 @@ bool Section::getPtrOf(unsigned lineNum, const char *memberName, bool isWriteAcc
   if (isWriteAccess)
     setActive(true);
   // Search section member
-  for (unsigned i = 0; i < m_tableSize; ++i) {
-    if (strcmp(memberName, m_memberTable[i].memberName) == 0) {
-      memberAddr = getMemberAddr(i);
-      if (arrayIndex >= m_memberTable[i].arrayMaxSize) {
-        PARSE_ERROR(*errorMsg, lineNum, "Array access out of bound: %u of %s[%u]", arrayIndex, memberName,
-                    m_memberTable[i].arrayMaxSize);
-        result = false;
-      }
-      arrayMaxSize = m_memberTable[i].arrayMaxSize;
-      break;
+  unsigned i = findMember(memberName);
+  if (i != m_tableSize) {
+    memberAddr = getMemberAddr(i);
+    if (arrayIndex >= m_memberTable[i].arrayMaxSize) {
+      PARSE_ERROR(*errorMsg, lineNum, "Array access out of bound: %u of %s[%u]", arrayIndex, memberName,
+                  m_memberTable[i].arrayMaxSize);
+      result = false;
     }
+    arrayMaxSize = m_memberTable[i].arrayMaxSize;
   }
 
   if (result && memberAddr == reinterpret_cast<void *>(static_cast<size_t>(VfxInvalidValue))) {
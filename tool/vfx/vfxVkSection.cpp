@@ -89,6 +89,11 @@ public:
     ADD_CLASS_ENUM_MAP(DenormalMode, Auto)
     ADD_CLASS_ENUM_MAP(DenormalMode, FlushToZero)
     ADD_CLASS_ENUM_MAP(DenormalMode, Preserve)
+
+    ADD_CLASS_ENUM_MAP(WorkgroupIdSwizzle, None)
+    ADD_CLASS_ENUM_MAP(WorkgroupIdSwizzle, Tiled)
+    ADD_CLASS_ENUM_MAP(WorkgroupIdSwizzle, Morton)
+    ADD_CLASS_ENUM_MAP(WorkgroupIdSwizzle, ColumnStrips)
   }
 };
 